@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+#include "..\include\neolib\random.hpp"
+
+// coordinate hashes over a 1024 x 1024 block of lattice points, as the noise lattice looks them up;
+// cycles are time stamp counter ticks, which run at the base clock rather than the boosted one
+void benchHash(std::ostream& out) {
+	using clock = std::chrono::steady_clock;
+	constexpr nl::u32 side = 1024;
+	constexpr std::size_t n = std::size_t(side) * side;
+	constexpr nl::u32 seed = 12345;
+
+	std::vector<nl::u32> xs(n), ys(n), zs(n), ws(n), res(n);
+	for (std::size_t i = 0; i < n; i++) {
+		xs[i] = nl::u32(i % side) - side / 2;
+		ys[i] = nl::u32(i / side) - side / 2;
+		zs[i] = nl::u32(i >> 4);
+		ws[i] = nl::u32(i >> 8);
+	};
+
+	auto time = [&](const char* name, const auto& f) {
+		auto start = clock::now();
+		nl::u64 ticks = __rdtsc();
+		f();
+		ticks = __rdtsc() - ticks;
+		double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count() / double(n);
+
+		nl::u32 sink = 0;
+		for (nl::u32 r : res) sink ^= r;
+		out << std::setw(28) << name << std::setw(10) << std::fixed << std::setprecision(2) << ns << std::setw(10) << double(ticks) / double(n) << (sink == 1 ? " " : "") << "\n";
+	};
+
+	out << "coordinate hash, per hash\n";
+	out << std::setw(28) << "hash" << std::setw(10) << "ns" << std::setw(10) << "cycles" << "\n";
+
+	time("random_u32(x ^ quarter(y))", [&] {
+		for (std::size_t i = 0; i < n; i++) {
+			res[i] = nl::random_u32(xs[i] ^ nl::quarter_u32(ys[i])) * seed;
+		};
+	});
+	time("hash2d", [&] {
+		for (std::size_t i = 0; i < n; i++) {
+			res[i] = nl::hash2d(seed, xs[i], ys[i]);
+		};
+	});
+	time("hash2d batch", [&] { nl::hash2d(seed, xs, ys, res); });
+	time("hash3d", [&] {
+		for (std::size_t i = 0; i < n; i++) {
+			res[i] = nl::hash3d(seed, xs[i], ys[i], zs[i]);
+		};
+	});
+	time("hash3d batch", [&] { nl::hash3d(seed, xs, ys, zs, res); });
+	time("hash4d", [&] {
+		for (std::size_t i = 0; i < n; i++) {
+			res[i] = nl::hash4d(seed, xs[i], ys[i], zs[i], ws[i]);
+		};
+	});
+	time("hash4d batch", [&] { nl::hash4d(seed, xs, ys, zs, ws, res); });
+	out << "\n";
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+#include "..\include\neolib\flat_map.hpp"
+#include "..\include\neolib\random.hpp"
+
+// nl::flat_map against std::unordered_map on s32vec2 keys, in the access patterns of the noise
+// lattice caches: filling a region row by row, revisiting it in the same order, random hits and
+// lookups of keys that were never inserted
+template<typename M> void benchHashMapPass(std::ostream& out, const char* name, nl::s32 side) {
+	using clock = std::chrono::steady_clock;
+	std::size_t n = std::size_t(side) * side;
+
+	std::vector<nl::s32vec2> shuffled;
+	shuffled.reserve(n);
+	for (nl::u32 i = 0; i < n; i++) {
+		nl::u32 r = nl::random_u32(i + 1) % nl::u32(n);
+		shuffled.push_back(nl::s32vec2(nl::s32(r % nl::u32(side)) - side / 2, nl::s32(r / nl::u32(side)) - side / 2));
+	};
+
+	auto time = [&](const auto& f) {
+		auto start = clock::now();
+		nl::u64 sink = f();
+		double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count() / double(n);
+		out << std::setw(10) << std::fixed << std::setprecision(2) << ns << (sink == 1 ? " " : "");
+	};
+
+	M map;
+	out << std::setw(16) << name << std::setw(10) << n;
+
+	time([&] {
+		for (nl::s32 y = -side / 2; y < side - side / 2; y++) {
+			for (nl::s32 x = -side / 2; x < side - side / 2; x++) {
+				map.emplace(nl::s32vec2(x, y), nl::u32(x ^ y));
+			};
+		};
+		return nl::u64(map.size());
+	});
+
+	time([&] {
+		nl::u64 sum = 0;
+		for (nl::s32 y = -side / 2; y < side - side / 2; y++) {
+			for (nl::s32 x = -side / 2; x < side - side / 2; x++) {
+				sum += map.find(nl::s32vec2(x, y))->second;
+			};
+		};
+		return sum;
+	});
+
+	time([&] {
+		nl::u64 sum = 0;
+		for (const nl::s32vec2& k : shuffled) {
+			sum += map.find(k)->second;
+		};
+		return sum;
+	});
+
+	time([&] {
+		nl::u64 sum = 0;
+		for (const nl::s32vec2& k : shuffled) {
+			sum += map.find(nl::s32vec2(k.x + side, k.y)) == map.end();
+		};
+		return sum;
+	});
+
+	out << "\n";
+};
+
+void benchHashMap(std::ostream& out) {
+	out << "hash map, ns per operation\n";
+	out << std::setw(16) << "map" << std::setw(10) << "entries" << std::setw(10) << "insert" << std::setw(10) << "rows" << std::setw(10) << "random" << std::setw(10) << "miss" << "\n";
+
+	for (nl::s32 side : { 32, 256, 1024 }) {
+		benchHashMapPass<std::unordered_map<nl::s32vec2, nl::u32>>(out, "unordered_map", side);
+		benchHashMapPass<nl::flat_map<nl::s32vec2, nl::u32>>(out, "flat_map", side);
+	};
+	out << "\n";
+};
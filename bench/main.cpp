@@ -0,0 +1,20 @@
+#include <fstream>
+#include <iostream>
+
+#include "hash.hpp"
+#include "hashmap.hpp"
+#include "random.hpp"
+
+// bench [results.json]: the tables go to stdout, the random benchmark's rows also to the file
+int main(int argc, char** argv) {
+	benchReport report;
+
+	benchHashMap(std::cout);
+	benchHash(std::cout);
+	benchRandom(std::cout, report);
+
+	if (argc > 1) {
+		std::ofstream json(argv[1]);
+		report.writeJson(json);
+	};
+};
@@ -0,0 +1,287 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "..\include\neolib\engine.hpp"
+#include "..\include\neolib\philox.hpp"
+#include "..\include\neolib\random.hpp"
+
+// cost and statistical quality of the random.hpp mixers, fed sequential seeds the way the noise code
+// feeds them coordinates and indices
+//
+// every figure is also recorded as a (group, name, metric, value) row, which main writes out as
+// json so runs can be compared over time; the quality metrics are
+//   avalanche worst / mean - |P(output bit flips) - 1/2| when one input bit flips, over every input
+//                            and output bit pair; 0 is ideal, 0.5 means a bit pair never interacts
+//   chi2 p                 - top 8 output bits of 2^20 sequential seeds against 256 equal buckets
+//   serial r               - correlation of consecutive outputs as [0, 1) values; 0 is ideal
+//   gap p                  - Knuth's gap test, gaps between outputs in [0, 1/8)
+// p values come from the Wilson-Hilferty normal approximation; values below 0.001 or above
+// 0.999 are failures, the latter meaning the output is too even to be random. The 8 and 16 bit
+// mixers are bijections run over their whole period, so their buckets come out exactly even
+struct benchRow {
+	std::string group;
+	std::string name;
+	std::string metric;
+	double value;
+};
+
+class benchReport {
+	std::vector<benchRow> rows;
+
+public:
+	void add(const std::string& group, const std::string& name, const std::string& metric, double value) {
+		rows.push_back({ group, name, metric, value });
+	};
+
+	void writeJson(std::ostream& out) const {
+		out << "[\n";
+		for (std::size_t i = 0; i < rows.size(); i++) {
+			const benchRow& r = rows[i];
+			out << "\t{ \"group\": \"" << r.group << "\", \"name\": \"" << r.name << "\", \"metric\": \"" << r.metric << "\", \"value\": ";
+			if (std::isfinite(r.value)) out << std::setprecision(9) << std::defaultfloat << r.value;
+			else out << "null";
+			out << (i + 1 < rows.size() ? " },\n" : " }\n");
+		};
+		out << "]\n";
+	};
+};
+
+// probability of a chi-square value this large or larger with dof degrees of freedom
+inline double chiSquareP(double chi2, double dof) {
+	double z = (std::cbrt(chi2 / dof) - (1.0 - 2.0 / (9.0 * dof))) / std::sqrt(2.0 / (9.0 * dof));
+	return 0.5 * std::erfc(z / std::sqrt(2.0));
+};
+
+inline double chiSquare(const std::vector<double>& observed, const std::vector<double>& expected) {
+	double chi2 = 0.0;
+	for (std::size_t i = 0; i < observed.size(); i++) {
+		double d = observed[i] - expected[i];
+		chi2 += d * d / expected[i];
+	};
+	return chi2;
+};
+
+template<typename T> double unitValue(T v) {
+	return double(v) / std::ldexp(1.0, sizeof(T) * 8);
+};
+
+template<typename T, typename F> void benchQuality(benchReport& report, std::ostream& out, const char* name, F f) {
+	constexpr nl::u32 bits = sizeof(T) * 8;
+	constexpr std::size_t n = std::size_t(1) << 20;
+
+	// avalanche: every input for the 8 and 16 bit mixers, 4096 spread-out inputs for the wider ones
+	std::vector<nl::u32> flips(bits * bits, 0);
+	std::size_t inputs = bits <= 16 ? std::size_t(1) << bits : 4096;
+	for (std::size_t s = 0; s < inputs; s++) {
+		T x = bits <= 16 ? T(s) : T(nl::mix64(s));
+		T fx = f(x);
+		for (nl::u32 i = 0; i < bits; i++) {
+			T d = fx ^ f(T(x ^ (T(1) << i)));
+			for (nl::u32 j = 0; j < bits; j++) {
+				flips[i * bits + j] += (d >> j) & 1;
+			};
+		};
+	};
+	double worst = 0.0, mean = 0.0;
+	for (nl::u32 c : flips) {
+		double bias = std::abs(double(c) / double(inputs) - 0.5);
+		worst = std::max(worst, bias);
+		mean += bias;
+	};
+	mean /= double(flips.size());
+
+	// chi-square of the top 8 bits, serial correlation and gap test over sequential seeds
+	std::vector<double> buckets(256, 0.0);
+	double sx = 0.0, sxx = 0.0, sxy = 0.0;
+	double prev = unitValue(f(T(0)));
+
+	constexpr nl::u32 maxGap = 32;
+	std::vector<double> gaps(maxGap + 1, 0.0);
+	std::size_t gap = 0, gapCount = 0;
+
+	for (std::size_t s = 0; s < n; s++) {
+		T v = f(T(s));
+		buckets[std::size_t(v >> (bits - 8))]++;
+
+		double u = unitValue(v);
+		if (s > 0) {
+			sx += prev;
+			sxx += prev * prev;
+			sxy += prev * u;
+		};
+		prev = u;
+
+		if (u < 0.125) {
+			gaps[std::min<std::size_t>(gap, maxGap)]++;
+			gapCount++;
+			gap = 0;
+		}
+		else gap++;
+	};
+
+	double chi2P = chiSquareP(chiSquare(buckets, std::vector<double>(256, double(n) / 256.0)), 255.0);
+
+	double m = double(n - 1);
+	double var = sxx / m - (sx / m) * (sx / m);
+	double serial = (sxy / m - (sx / m) * (sx / m)) / var;
+
+	// gap lengths are geometric with p = 1/8, the last bucket holding every longer gap
+	std::vector<double> expected(maxGap + 1);
+	for (nl::u32 k = 0; k < maxGap; k++) {
+		expected[k] = double(gapCount) * 0.125 * std::pow(0.875, double(k));
+	};
+	expected[maxGap] = double(gapCount) * std::pow(0.875, double(maxGap));
+	// no output ever landing in [0, 1/8) is a failure the chi-square cannot express
+	double gapP = gapCount == 0 ? 0.0 : chiSquareP(chiSquare(gaps, expected), double(maxGap));
+
+	out << std::fixed << std::setprecision(4) << std::setw(10) << worst << std::setw(10) << mean << std::setw(10) << chi2P << std::setw(10) << serial << std::setw(10) << gapP << "\n";
+
+	report.add("quality", name, "avalanche worst", worst);
+	report.add("quality", name, "avalanche mean", mean);
+	report.add("quality", name, "chi2 p", chi2P);
+	report.add("quality", name, "serial r", serial);
+	report.add("quality", name, "gap p", gapP);
+};
+
+template<typename T, typename F> void benchMixer(benchReport& report, std::ostream& out, const char* name, F f) {
+	using clock = std::chrono::steady_clock;
+	constexpr std::size_t n = std::size_t(1) << 22;
+
+	std::vector<T> res(n);
+	auto start = clock::now();
+	for (std::size_t i = 0; i < n; i++) {
+		res[i] = f(T(i));
+	};
+	double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count() / double(n);
+
+	T sink = 0;
+	for (T r : res) sink ^= r;
+	out << std::setw(16) << name << std::fixed << std::setprecision(2) << std::setw(10) << ns << (sink == 1 ? " " : "");
+	report.add("scalar", name, "ns", ns);
+
+	benchQuality<T>(report, out, name, f);
+};
+
+template<typename F8, typename F16, typename F32, typename F64> void benchMixerFamily(benchReport& report, std::ostream& out, const std::string& family, F8 f8, F16 f16, F32 f32, F64 f64) {
+	benchMixer<nl::u8>(report, out, (family + "_u8").c_str(), f8);
+	benchMixer<nl::u16>(report, out, (family + "_u16").c_str(), f16);
+	benchMixer<nl::u32>(report, out, (family + "_u32").c_str(), f32);
+	benchMixer<nl::u64>(report, out, (family + "_u64").c_str(), f64);
+};
+
+// the old lattice hash x ^ quarter_u32(y) against hash2d on a 512 x 512 block around the origin:
+//   distinct - share of distinct values; a random hash repeats about 8 of the 2^18, while every
+//              input the old hash sees twice is a repeated lattice value
+//   pairs p  - chi-square p of the top 4 bits of each cell against its right, lower and diagonal
+//              neighbour, 256 buckets each; the smallest of p and 1 - p over the three, so values
+//              near 0 fail either way
+template<typename F> void benchLattice(benchReport& report, std::ostream& out, const char* name, F f) {
+	constexpr nl::s32 side = 512;
+	constexpr std::size_t n = std::size_t(side) * side;
+
+	std::vector<nl::u32> values(n);
+	for (nl::s32 y = 0; y < side; y++) {
+		for (nl::s32 x = 0; x < side; x++) {
+			values[std::size_t(y) * side + x] = f(nl::u32(x - side / 2), nl::u32(y - side / 2));
+		};
+	};
+
+	double worstP = 1.0;
+	const nl::s32 offsets[3][2] = { { 1, 0 }, { 0, 1 }, { 1, 1 } };
+	for (const auto& o : offsets) {
+		std::vector<double> buckets(256, 0.0);
+		double count = 0.0;
+		for (nl::s32 y = 0; y + o[1] < side; y++) {
+			for (nl::s32 x = 0; x + o[0] < side; x++) {
+				nl::u32 a = values[std::size_t(y) * side + x] >> 28;
+				nl::u32 b = values[std::size_t(y + o[1]) * side + x + o[0]] >> 28;
+				buckets[a * 16 + b]++;
+				count++;
+			};
+		};
+		double p = chiSquareP(chiSquare(buckets, std::vector<double>(256, count / 256.0)), 255.0);
+		worstP = std::min(worstP, std::min(p, 1.0 - p));
+	};
+
+	std::sort(values.begin(), values.end());
+	double distinct = double(std::unique(values.begin(), values.end()) - values.begin()) / double(n);
+
+	out << std::setw(28) << name << std::fixed << std::setprecision(4) << std::setw(10) << distinct << std::setw(10) << worstP << "\n";
+	report.add("lattice", name, "distinct", distinct);
+	report.add("lattice", name, "pairs p", worstP);
+};
+
+void benchRandom(std::ostream& out, benchReport& report) {
+	using clock = std::chrono::steady_clock;
+
+	out << "random mixers, sequential seeds\n";
+	out << std::setw(16) << "mixer" << std::setw(10) << "ns" << std::setw(10) << "aval max" << std::setw(10) << "aval avg" << std::setw(10) << "chi2 p" << std::setw(10) << "serial r" << std::setw(10) << "gap p" << "\n";
+
+	benchMixerFamily(report, out, "randombit",
+		[](nl::u8 s) { return nl::randombit_u8(s); }, [](nl::u16 s) { return nl::randombit_u16(s); },
+		[](nl::u32 s) { return nl::randombit_u32(s); }, [](nl::u64 s) { return nl::randombit_u64(s); });
+	benchMixerFamily(report, out, "randomlcg",
+		[](nl::u8 s) { return nl::randomlcg_u8(s); }, [](nl::u16 s) { return nl::randomlcg_u16(s); },
+		[](nl::u32 s) { return nl::randomlcg_u32(s); }, [](nl::u64 s) { return nl::randomlcg_u64(s); });
+	benchMixerFamily(report, out, "quarter",
+		[](nl::u8 s) { return nl::quarter_u8(s); }, [](nl::u16 s) { return nl::quarter_u16(s); },
+		[](nl::u32 s) { return nl::quarter_u32(s); }, [](nl::u64 s) { return nl::quarter_u64(s); });
+	benchMixerFamily(report, out, "eighth",
+		[](nl::u8 s) { return nl::eighth_u8(s); }, [](nl::u16 s) { return nl::eighth_u16(s); },
+		[](nl::u32 s) { return nl::eighth_u32(s); }, [](nl::u64 s) { return nl::eighth_u64(s); });
+	benchMixerFamily(report, out, "deprime",
+		[](nl::u8 s) { return nl::deprime_u8(s); }, [](nl::u16 s) { return nl::deprime_u16(s); },
+		[](nl::u32 s) { return nl::deprime_u32(s); }, [](nl::u64 s) { return nl::deprime_u64(s); });
+	benchMixerFamily(report, out, "random",
+		[](nl::u8 s) { return nl::random_u8(s); }, [](nl::u16 s) { return nl::random_u16(s); },
+		[](nl::u32 s) { return nl::random_u32(s); }, [](nl::u64 s) { return nl::random_u64(s); });
+	benchMixer<nl::u64>(report, out, "mix64", [](nl::u64 s) { return nl::mix64(s); });
+	benchMixer<nl::u64>(report, out, "philox", [](nl::u64 s) { return nl::philox(12345).value(s); });
+	out << "\n";
+
+	// batch forms, per value
+	constexpr std::size_t n = std::size_t(1) << 22;
+	std::vector<nl::u32> seeds(n);
+	std::vector<nl::u64> seeds64(n);
+	for (std::size_t i = 0; i < n; i++) {
+		seeds[i] = nl::u32(i);
+		seeds64[i] = i;
+	};
+	std::vector<nl::u32> u32s(n);
+	std::vector<nl::s32> s32s(n);
+	std::vector<nl::u64> u64s(n);
+	std::vector<nl::f64> f64s(n);
+
+	auto time = [&](const char* name, const auto& f) {
+		auto start = clock::now();
+		f();
+		double ns = std::chrono::duration<double, std::nano>(clock::now() - start).count() / double(n);
+		out << std::setw(28) << name << std::fixed << std::setprecision(2) << std::setw(10) << ns << (u32s[1] + s32s[1] + u64s[1] + f64s[1] == 1.5 ? " " : "") << "\n";
+		report.add("batch", name, "ns", ns);
+	};
+
+	out << "batch forms, per value\n";
+	out << std::setw(28) << "function" << std::setw(10) << "ns" << "\n";
+	time("random_u32", [&] { nl::random_u32(seeds, u32s); });
+	time("random_s32", [&] { nl::random_s32(seeds, s32s); });
+	time("random_u64", [&] { nl::random_u64(seeds64, u64s); });
+	time("random_clamped_uf64", [&] { nl::random_clamped_uf64(seeds, f64s); });
+	time("random_clamped_sf64", [&] { nl::random_clamped_sf64(seeds, f64s); });
+	time("engine::generate", [&] { nl::engine(12345).generate(u64s); });
+	time("philox::generate u32", [&] { nl::philox(12345).generate(0, u32s); });
+	time("philox::generate u64", [&] { nl::philox(12345).generate(0, u64s); });
+	out << "\n";
+
+	out << "2d lattice hash, 512 x 512\n";
+	out << std::setw(28) << "hash" << std::setw(10) << "distinct" << std::setw(10) << "pairs p" << "\n";
+	benchLattice(report, out, "random_u32(x ^ quarter(y))", [](nl::u32 x, nl::u32 y) { return nl::random_u32(x ^ nl::quarter_u32(y)); });
+	benchLattice(report, out, "hash2d", [](nl::u32 x, nl::u32 y) { return nl::hash2d(12345, x, y); });
+	out << "\n";
+};
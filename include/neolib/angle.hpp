@@ -1,11 +1,119 @@
 #pragma once
 
+#include <array>
 #include <numbers>
+#include <span>
 
 #include "math.hpp"
 #include "random.hpp"
+#include "simd.hpp"
 
 namespace nl {
+	// accuracy tiers of sincos, by largest absolute error for angles within a few thousand radians
+	//   exact   - std::sin and std::cos
+	//   table   - the nearest of 256 table entries turned by the remainder, whose sin and cos are
+	//             short Taylor polynomials; 3e-12
+	//   minimax - the nearest quadrant turned the same way, with minimax polynomials of degree 7 and
+	//             6 over [-pi / 4, pi / 4]; 3.3e-8, below f32 resolution
+	enum class sincosTier {
+		exact, table, minimax
+	};
+
+	struct sincosPair {
+		f64 sin;
+		f64 cos;
+	};
+
+	// sin and cos of k * tau / N
+	template<u32 N> struct sincosTable {
+		std::array<f64, N> sin, cos;
+	};
+
+	template<u32 N> const sincosTable<N>& getSincosTable() {
+		static const sincosTable<N> table = [] {
+			sincosTable<N> res;
+			for (u32 i = 0; i < N; i++) {
+				res.sin[i] = std::sin(f64(i) * 2.0 * std::numbers::pi / f64(N));
+				res.cos[i] = std::cos(f64(i) * 2.0 * std::numbers::pi / f64(N));
+			};
+			return res;
+		}();
+		return table;
+	};
+
+	// sin and cos of k * tau / N + d for |d| <= pi / N: sin = sin(k) cos d + cos(k) sin d, cos =
+	// cos(k) cos d - sin(k) sin d. Written on simd::pack so the scalar and batch forms give identical
+	// results
+	template<u32 N, typename P> void sincosTurned(const typename P::index& k, const P& d, P& s, P& c) {
+		using I = typename P::index;
+		const sincosTable<N>& table = getSincosTable<N>();
+
+		P d2 = d * d;
+		P sd, cd;
+		if constexpr (N == 4) {
+			sd = d + d * d2 * (P::broadcast(-0.1666665066859346) + d2 * (P::broadcast(0.008331978623663215) + d2 * P::broadcast(-0.00019495631213338325)));
+			cd = P::broadcast(1.0) + d2 * (P::broadcast(-0.49999894776149795) + d2 * (P::broadcast(0.04165629423549765) + d2 * P::broadcast(-0.0013597818311007616)));
+		}
+		else {
+			sd = d - d * d2 * P::broadcast(1.0 / 6.0);
+			cd = P::broadcast(1.0) + d2 * (P::broadcast(-0.5) + d2 * P::broadcast(1.0 / 24.0));
+		};
+
+		I i = k & I::broadcast(N - 1);
+		P ts = P::gather(table.sin.data(), i);
+		P tc = P::gather(table.cos.data(), i);
+		s = ts * cd + tc * sd;
+		c = tc * cd - ts * sd;
+	};
+
+	// x split into the nearest multiple k of tau / N and the remainder d
+	template<u32 N, typename P> void sincosReduced(const P& x, P& s, P& c) {
+		P turns = x * P::broadcast(f64(N) / (2.0 * std::numbers::pi));
+		P k = (turns + P::broadcast(0.5)).floor();
+		P d = (turns - k) * P::broadcast(2.0 * std::numbers::pi / f64(N));
+		sincosTurned<N>(k.toIndex(), d, s, c);
+	};
+
+	inline sincosPair sincos(f64 x, sincosTier tier = sincosTier::exact) {
+		using P = simd::pack<f64, 1>;
+		P s, c;
+		switch (tier) {
+		case(sincosTier::table):
+			sincosReduced<256>(P{ x }, s, c);
+			return { s.v, c.v };
+			break;
+		case(sincosTier::minimax):
+			sincosReduced<4>(P{ x }, s, c);
+			return { s.v, c.v };
+			break;
+		default:
+			return { std::sin(x), std::cos(x) };
+			break;
+		};
+	};
+
+	// sines[i] and cosines[i] of angles[i], simd::f64width at a time; both outputs must hold at least
+	// angles.size() values
+	inline void sincos(std::span<const f64> angles, std::span<f64> sines, std::span<f64> cosines, sincosTier tier = sincosTier::exact) {
+		using P = simd::f64pack;
+
+		std::size_t i = 0;
+		if (tier != sincosTier::exact) {
+			for (; i + P::width <= angles.size(); i += P::width) {
+				P s, c;
+				if (tier == sincosTier::table) sincosReduced<256>(P::load(angles.data() + i), s, c);
+				else sincosReduced<4>(P::load(angles.data() + i), s, c);
+				s.store(sines.data() + i);
+				c.store(cosines.data() + i);
+			};
+		};
+		for (; i < angles.size(); i++) {
+			sincosPair p = sincos(angles[i], tier);
+			sines[i] = p.sin;
+			cosines[i] = p.cos;
+		};
+	};
+
 	struct angle {
 	public:
 		static constexpr f64 pi = std::numbers::pi;
@@ -149,6 +257,10 @@ namespace nl {
 			return clamp();
 		};
 
+		sincosPair sincos(sincosTier tier = sincosTier::exact) const {
+			return nl::sincos(a, tier);
+		};
+
 		static constexpr angle random(const u32& seed, const f64& range) {
 			return angle(random_clamped_uf64(seed) * range);
 		};
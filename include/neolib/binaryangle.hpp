@@ -0,0 +1,156 @@
+#pragma once
+
+#include <span>
+#include <type_traits>
+
+#include "angle.hpp"
+#include "simd.hpp"
+
+namespace nl {
+	// an angle in units of 2^-16 or 2^-32 of a full turn: wrapping around is plain integer overflow,
+	// so adding, subtracting and scaling never need the mod and floor angle::clamp runs on every
+	// update. Headings and rotations that are stepped many times per frame keep their state in it and
+	// convert to angle, or take sin and cos straight from the units, when needed
+	template<typename U> struct binaryAngle {
+		static_assert(std::is_same_v<U, u16> || std::is_same_v<U, u32>, "binary angles are u16 or u32 units of a turn");
+
+		using units = U;
+		using signedUnits = std::make_signed_t<U>;
+
+		static constexpr u32 bits = sizeof(U) * 8;
+		static constexpr f64 unitsPerTurn = f64(u64(1) << bits);
+		static constexpr f64 unitsPerRadian = unitsPerTurn / angle::tau;
+
+		U v = 0;
+
+		constexpr binaryAngle() = default;
+		constexpr binaryAngle(const angle& a) {
+			v = fromRadians(a.val()).v;
+		};
+
+		static constexpr binaryAngle fromUnits(U u) {
+			binaryAngle res;
+			res.v = u;
+			return res;
+		};
+
+		// nearest unit, any number of turns
+		static constexpr binaryAngle fromRadians(f64 x) {
+			f64 u = x * unitsPerRadian;
+			return fromUnits(U(u64(s64(u < 0.0 ? u - 0.5 : u + 0.5))));
+		};
+
+		static constexpr binaryAngle fromDegrees(f64 x) {
+			return fromRadians(x * angle::dtor);
+		};
+
+		// the same angle in the other width; narrowing rounds to the nearest unit
+		template<typename V> constexpr explicit binaryAngle(const binaryAngle<V>& b) {
+			if constexpr (sizeof(V) <= sizeof(U)) {
+				v = U(U(b.v) << (bits - b.bits));
+			}
+			else {
+				v = U((b.v + (V(1) << (b.bits - bits - 1))) >> (b.bits - bits));
+			};
+		};
+
+		constexpr U raw() const { return v; };
+
+		// [-half turn, half turn), e.g. the signed turn from one heading to another: (b - a).toSigned()
+		constexpr signedUnits toSigned() const { return signedUnits(v); };
+
+		// [0, tau)
+		constexpr f64 radians() const { return f64(v) * (angle::tau / unitsPerTurn); };
+		constexpr angle toAngle() const { return angle(radians(), angle::at::urad); };
+
+		// table-driven: the top 8 bits, rounded, pick one of the 256 entries angle's sincosTier::table uses
+		// and the remaining bits turn it exactly as they do there, without the float range reduction
+		sincosPair sincos() const {
+			using P = simd::pack<f64, 1>;
+			P s, c;
+			u32 t = u32(v) << (32 - bits);
+			u32 k = (t + (1u << 23)) >> 24;
+			sincosTurned<256>(simd::upack<1>{ k }, P{ f64(s32(t - (k << 24))) * (angle::tau / 4294967296.0) }, s, c);
+			return { s.v, c.v };
+		};
+
+		f64 sin() const { return sincos().sin; };
+		f64 cos() const { return sincos().cos; };
+
+		constexpr binaryAngle& operator+=(const binaryAngle& b) { v = U(v + b.v); return *this; };
+		constexpr binaryAngle& operator-=(const binaryAngle& b) { v = U(v - b.v); return *this; };
+		constexpr binaryAngle& operator*=(s32 x) { v = U(u32(v) * u32(x)); return *this; };
+		constexpr binaryAngle& operator/=(u32 x) { v = U(v / x); return *this; };
+
+		constexpr bool operator==(const binaryAngle& b) const { return v == b.v; };
+		constexpr bool operator!=(const binaryAngle& b) const { return v != b.v; };
+	};
+
+	using angle16 = binaryAngle<u16>;
+	using angle32 = binaryAngle<u32>;
+
+	template<typename U> constexpr binaryAngle<U> operator+(binaryAngle<U> a, const binaryAngle<U>& b) { return a += b; };
+	template<typename U> constexpr binaryAngle<U> operator-(binaryAngle<U> a, const binaryAngle<U>& b) { return a -= b; };
+	template<typename U> constexpr binaryAngle<U> operator*(binaryAngle<U> a, s32 x) { return a *= x; };
+	template<typename U> constexpr binaryAngle<U> operator/(binaryAngle<U> a, u32 x) { return a /= x; };
+	template<typename U> constexpr binaryAngle<U> operator-(const binaryAngle<U>& a) { return binaryAngle<U>::fromUnits(U(0 - a.v)); };
+
+	// batch forms over spans, simd::f64width angles at a time; outputs must hold at least angles.size()
+	// values. Every angle is widened to u32 units first, which is exact, so both widths share one kernel
+	template<typename U> void sincos(std::span<const binaryAngle<U>> angles, std::span<f64> sines, std::span<f64> cosines) {
+		using P = simd::f64pack;
+		using I = P::index;
+		constexpr u32 shift = 32 - binaryAngle<U>::bits;
+
+		std::size_t i = 0;
+		for (; i + P::width <= angles.size(); i += P::width) {
+			u32 units[P::width];
+			for (std::size_t l = 0; l < P::width; l++) units[l] = u32(angles[i + l].v) << shift;
+
+			I t = I::load(units);
+			I k = (t + I::broadcast(1u << 23)) >> 24;
+			P d = P::fromIndex(t - (k << 24)) * P::broadcast(angle::tau / 4294967296.0);
+
+			P s, c;
+			sincosTurned<256>(k, d, s, c);
+			s.store(sines.data() + i);
+			c.store(cosines.data() + i);
+		};
+		for (; i < angles.size(); i++) {
+			sincosPair p = angles[i].sincos();
+			sines[i] = p.sin;
+			cosines[i] = p.cos;
+		};
+	};
+
+	// out[i] = angles[i] in radians, [0, tau)
+	template<typename U> void toRadians(std::span<const binaryAngle<U>> angles, std::span<f64> out) {
+		using P = simd::f64pack;
+		using I = P::index;
+		constexpr u32 shift = 32 - binaryAngle<U>::bits;
+
+		std::size_t i = 0;
+		for (; i + P::width <= angles.size(); i += P::width) {
+			u32 units[P::width];
+			for (std::size_t l = 0; l < P::width; l++) units[l] = u32(angles[i + l].v) << shift;
+			(P::fromUnsigned(I::load(units)) * P::broadcast(angle::tau / 4294967296.0)).store(out.data() + i);
+		};
+		for (; i < angles.size(); i++) {
+			out[i] = angles[i].radians();
+		};
+	};
+
+	// angles[i] += steps[i], wrapping; a plain integer loop the compiler vectorises at any width
+	template<typename U> void advance(std::span<binaryAngle<U>> angles, std::span<const binaryAngle<U>> steps) {
+		for (std::size_t i = 0; i < angles.size(); i++) {
+			angles[i].v = U(angles[i].v + steps[i].v);
+		};
+	};
+
+	// angles[i] += step
+	template<typename U> void advance(std::span<binaryAngle<U>> angles, const binaryAngle<U>& step) {
+		for (std::size_t i = 0; i < angles.size(); i++) {
+			angles[i].v = U(angles[i].v + step.v);
+		};
+	};
+};
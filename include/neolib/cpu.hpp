@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdlib>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#include "base.hpp"
+
+// gcc and clang only emit BMI2 instructions in functions compiled for it; other targets have no bmi2
+// to ask for, and gcc rejects the attribute there
+#if defined(__GNUC__) && !defined(__BMI2__) && (defined(__x86_64__) || defined(__i386__))
+#define NL_TARGET_BMI2 __attribute__((target("bmi2")))
+#else
+#define NL_TARGET_BMI2
+#endif
+
+namespace nl {
+	// extensions of the CPU the program runs on, read once with cpuid
+	struct cpuFeatures {
+		bool bmi2 = false;
+		// pdep / pext run in hardware; AMD before Zen 3 microcodes them at dozens to hundreds of cycles
+		bool fastPdep = false;
+	};
+
+	inline cpuFeatures detectCpu() {
+		cpuFeatures res;
+#if defined(_M_X64) || defined(__x86_64__)
+		u32 r[4] = {};
+		auto cpuid = [&r](u32 leaf) {
+#if defined(_MSC_VER)
+			int regs[4];
+			__cpuidex(regs, int(leaf), 0);
+			for (u32 i = 0; i < 4; i++) r[i] = u32(regs[i]);
+#else
+			__cpuid_count(leaf, 0, r[0], r[1], r[2], r[3]);
+#endif
+		};
+
+		cpuid(0);
+		u32 leaves = r[0];
+		bool amd = r[1] == 0x68747541 && r[3] == 0x69746e65 && r[2] == 0x444d4163;
+		if (leaves < 7) return res;
+
+		cpuid(1);
+		u32 family = (r[0] >> 8) & 0xf;
+		if (family == 0xf) family += (r[0] >> 20) & 0xff;
+
+		cpuid(7);
+		res.bmi2 = (r[1] >> 8) & 1;
+		res.fastPdep = res.bmi2 && !(amd && family < 0x19);
+#endif
+		return res;
+	};
+
+	// zero until detectCpu has run, so code reached from other static initialisers takes the
+	// portable paths
+	inline const cpuFeatures cpu = detectCpu();
+
+	// the bits of x in the set positions of mask, lowest first (pdep); the portable loop is only
+	// there for builds without BMI2, callers check cpu.fastPdep first
+	NL_TARGET_BMI2 inline u32 deposit(u32 x, u32 mask) {
+#if defined(_M_X64) || defined(__x86_64__)
+		return _pdep_u32(x, mask);
+#else
+		u32 res = 0;
+		for (u32 bit = 1; mask; bit <<= 1, mask &= mask - 1) {
+			if (x & bit) res |= mask & (0 - mask);
+		};
+		return res;
+#endif
+	};
+
+	NL_TARGET_BMI2 inline u64 deposit(u64 x, u64 mask) {
+#if defined(_M_X64) || defined(__x86_64__)
+		return _pdep_u64(x, mask);
+#else
+		u64 res = 0;
+		for (u64 bit = 1; mask; bit <<= 1, mask &= mask - 1) {
+			if (x & bit) res |= mask & (0 - mask);
+		};
+		return res;
+#endif
+	};
+
+	inline u16 byteswap(u16 x) {
+#if defined(_MSC_VER)
+		return _byteswap_ushort(x);
+#else
+		return __builtin_bswap16(x);
+#endif
+	};
+
+	inline u32 byteswap(u32 x) {
+#if defined(_MSC_VER)
+		return _byteswap_ulong(x);
+#else
+		return __builtin_bswap32(x);
+#endif
+	};
+
+	inline u64 byteswap(u64 x) {
+#if defined(_MSC_VER)
+		return _byteswap_uint64(x);
+#else
+		return __builtin_bswap64(x);
+#endif
+	};
+};
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <span>
+
+#include "engine.hpp"
+
+namespace nl {
+	// [0, 1) from the high 52 (23) bits of bits: they become the mantissa of a float in [1, 2), which
+	// then has one subtracted, so there is no int to float conversion and no division. Every value
+	// is a multiple of 2^-52 (2^-23)
+	constexpr f64 unitFloat64(u64 bits) {
+		return std::bit_cast<f64>(0x3ff0000000000000 | (bits >> 12)) - 1.0;
+	};
+
+	constexpr f32 unitFloat32(u32 bits) {
+		return std::bit_cast<f32>(0x3f800000 | (bits >> 9)) - 1.0f;
+	};
+
+	// the distributions below draw from G, nl::engine or any generator returning uniform u64; fill(g, out)
+	// is a convenience loop of calls, so it gives the values repeated calls would and leaves g in the
+	// same state. Drawing in blocks through engine::generate measured slower than the calls
+	template<typename D, typename G, typename T> void fillSamples(const D& d, G& g, std::span<T> out) {
+		for (T& v : out) {
+			v = d(g);
+		};
+	};
+
+	// uniform in [min, max)
+	template<typename T = f64> struct uniformReal {
+		T min = T(0);
+		T max = T(1);
+
+		template<typename G> T operator()(G& g) const {
+			if constexpr (sizeof(T) == 4) {
+				return min + (max - min) * unitFloat32(u32(g() >> 32));
+			}
+			else {
+				return min + (max - min) * unitFloat64(g());
+			};
+		};
+
+		template<typename G> void fill(G& g, std::span<T> out) const {
+			fillSamples(*this, g, out);
+		};
+	};
+
+	// uniform in [min, max], max included: Lemire's multiply-shift, which maps a 32 bit draw onto the
+	// range with one multiply and rejects the few draws that would bias it; the division computing
+	// the rejection threshold only runs when a draw lands in the biased part
+	struct uniformInt {
+		s32 min = 0;
+		s32 max = 1;
+
+		template<typename G> s32 operator()(G& g) const {
+			u32 range = u32(max) - u32(min) + 1;
+			u32 x = u32(g() >> 32);
+			if (range == 0) return s32(x);
+
+			u64 m = u64(x) * range;
+			if (u32(m) < range) {
+				u32 threshold = (0 - range) % range;
+				while (u32(m) < threshold) {
+					m = u64(u32(g() >> 32)) * range;
+				};
+			};
+			return s32(u32(min) + u32(m >> 32));
+		};
+
+		template<typename G> void fill(G& g, std::span<s32> out) const {
+			fillSamples(*this, g, out);
+		};
+	};
+
+	// layer edges of a ziggurat for a decreasing density f on [0, inf) with inverse inv: Layers
+	// strips of area v, the lowest one including the tail beyond r; x[0] is the width the lowest
+	// strip's area would give a rectangle of height f(r)
+	template<u32 Layers> struct zigguratTable {
+		std::array<f64, Layers + 1> x;
+		// x[i + 1] / x[i]: a sample of strip i below it lies inside the strip's rectangle
+		std::array<f64, Layers> ratio;
+		// f(x[i])
+		std::array<f64, Layers + 1> f;
+
+		template<typename F, typename I> static zigguratTable build(f64 r, f64 v, F density, I inv) {
+			zigguratTable res;
+			res.x[0] = v / density(r);
+			res.x[1] = r;
+			for (u32 i = 2; i < Layers; i++) {
+				res.x[i] = inv(v / res.x[i - 1] + density(res.x[i - 1]));
+			};
+			res.x[Layers] = 0.0;
+
+			for (u32 i = 0; i < Layers; i++) {
+				res.ratio[i] = res.x[i + 1] / res.x[i];
+			};
+			for (u32 i = 0; i <= Layers; i++) {
+				res.f[i] = density(res.x[i]);
+			};
+			return res;
+		};
+	};
+
+	// normal distribution, Marsaglia and Tsang's ziggurat with 256 strips: about 99% of samples take
+	// one draw, a compare and a multiply; the rest test the curve or sample the tail beyond r
+	struct normal {
+		static constexpr f64 r = 3.6541528853610088;
+		static constexpr f64 v = 0.00492867323399;
+
+		f64 mean = 0.0;
+		f64 sigma = 1.0;
+
+		static const zigguratTable<256>& table() {
+			static const zigguratTable<256> t = zigguratTable<256>::build(r, v,
+				[](f64 x) { return std::exp(-0.5 * x * x); },
+				[](f64 y) { return std::sqrt(-2.0 * std::log(y)); });
+			return t;
+		};
+
+		// standard normal
+		template<typename G> static f64 sample(G& g) {
+			const zigguratTable<256>& t = table();
+
+			for (;;) {
+				u64 bits = g();
+				u32 i = u32(bits & 0xff);
+				f64 u = 2.0 * unitFloat64(bits) - 1.0;
+				f64 x = u * t.x[i];
+
+				if (std::abs(u) < t.ratio[i]) return x;
+
+				if (i == 0) {
+					// Marsaglia's tail method, beyond r
+					f64 a, b;
+					do {
+						a = -std::log(1.0 - unitFloat64(g())) / r;
+						b = -std::log(1.0 - unitFloat64(g()));
+					} while (2.0 * b < a * a);
+					return u < 0.0 ? -(r + a) : r + a;
+				};
+
+				if (t.f[i] + unitFloat64(g()) * (t.f[i + 1] - t.f[i]) < std::exp(-0.5 * x * x)) return x;
+			};
+		};
+
+		template<typename G> f64 operator()(G& g) const {
+			return mean + sigma * sample(g);
+		};
+
+		template<typename G> void fill(G& g, std::span<f64> out) const {
+			fillSamples(*this, g, out);
+		};
+	};
+
+	// exponential distribution with the given rate, the same ziggurat over exp(-x); the tail beyond
+	// r is r plus another exponential sample, as the distribution is memoryless
+	struct exponential {
+		static constexpr f64 r = 7.69711747013104972;
+		static constexpr f64 v = 0.0039496598225815571993;
+
+		f64 rate = 1.0;
+
+		static const zigguratTable<256>& table() {
+			static const zigguratTable<256> t = zigguratTable<256>::build(r, v,
+				[](f64 x) { return std::exp(-x); },
+				[](f64 y) { return -std::log(y); });
+			return t;
+		};
+
+		// rate 1
+		template<typename G> static f64 sample(G& g) {
+			const zigguratTable<256>& t = table();
+
+			for (;;) {
+				u64 bits = g();
+				u32 i = u32(bits & 0xff);
+				f64 u = unitFloat64(bits);
+				f64 x = u * t.x[i];
+
+				if (u < t.ratio[i]) return x;
+				if (i == 0) return r - std::log(1.0 - unitFloat64(g()));
+				if (t.f[i] + unitFloat64(g()) * (t.f[i + 1] - t.f[i]) < std::exp(-x)) return x;
+			};
+		};
+
+		template<typename G> f64 operator()(G& g) const {
+			return sample(g) / rate;
+		};
+
+		template<typename G> void fill(G& g, std::span<f64> out) const {
+			fillSamples(*this, g, out);
+		};
+	};
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <limits>
+#include <span>
+
+#include "random.hpp"
+
+namespace nl {
+	// a stateful generator for code that draws many values: the state steps through randomlcg_u64,
+	// whose period is the full 2^64, and every step is output through mix64
+	//
+	// satisfies UniformRandomBitGenerator, so it plugs into the std distributions; jump(n) skips n
+	// values in O(log n), which split() uses to hand out non-overlapping substreams, e.g. one per
+	// worker thread, that are the same on every run for the same seed
+	class engine {
+	public:
+		using result_type = u64;
+
+		static constexpr u64 multiplier = 6364136223846793005;
+		static constexpr u64 increment = 100000001;
+
+		// values each split() substream may draw before running into the next one
+		static constexpr u64 splitDistance = u64(1) << 48;
+
+	private:
+		u64 state;
+
+		// the lcg applied n times, as one multiply and add: state * mul + add
+		struct affine {
+			u64 mul;
+			u64 add;
+		};
+
+		static constexpr affine power(u64 n) {
+			affine res{ 1, 0 };
+			affine step{ multiplier, increment };
+			while (n) {
+				if (n & 1) {
+					res.mul *= step.mul;
+					res.add = res.add * step.mul + step.add;
+				};
+				step.add *= step.mul + 1;
+				step.mul *= step.mul;
+				n >>= 1;
+			};
+			return res;
+		};
+
+	public:
+		constexpr engine(u64 seed = 0) { state = seed; };
+
+		static constexpr result_type min() { return 0; };
+		static constexpr result_type max() { return std::numeric_limits<u64>::max(); };
+
+		constexpr result_type operator()() {
+			state = randomlcg_u64(state);
+			return mix64(state);
+		};
+
+		// as if n values had been drawn
+		constexpr void jump(u64 n) {
+			affine a = power(n);
+			state = state * a.mul + a.add;
+		};
+
+		// an engine drawing this one's next splitDistance values; this one skips past them
+		constexpr engine split() {
+			engine res = *this;
+			jump(splitDistance);
+			return res;
+		};
+
+		// fills out with the values repeated calls would return; lanes independent lcg chains, each
+		// stepping lanes values at a time, keep the multipliers busy and let the compiler vectorise
+		void generate(std::span<u64> out) {
+			constexpr u32 lanes = 8;
+			constexpr affine stride = power(lanes);
+
+			std::size_t i = 0;
+			if (out.size() >= lanes) {
+				u64 s[lanes];
+				s[0] = randomlcg_u64(state);
+				for (u32 l = 1; l < lanes; l++) {
+					s[l] = randomlcg_u64(s[l - 1]);
+				};
+
+				for (; i + lanes <= out.size(); i += lanes) {
+					for (u32 l = 0; l < lanes; l++) {
+						out[i + l] = mix64(s[l]);
+					};
+					state = s[lanes - 1];
+					for (u32 l = 0; l < lanes; l++) {
+						s[l] = s[l] * stride.mul + stride.add;
+					};
+				};
+			};
+			for (; i < out.size(); i++) {
+				out[i] = (*this)();
+			};
+		};
+
+		constexpr bool operator==(const engine& b) const { return state == b.state; };
+		constexpr bool operator!=(const engine& b) const { return state != b.state; };
+	};
+};
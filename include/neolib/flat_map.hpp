@@ -0,0 +1,264 @@
+#pragma once
+
+#include <bit>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#endif
+
+#include "base.hpp"
+#include "random.hpp"
+#include "vector\vector2.hpp"
+#include "vector\vector3.hpp"
+
+namespace nl {
+	// deterministic hashes for flat_map; integer vectors pack their components before mixing, so
+	// neighbouring lattice coordinates land in unrelated groups
+	template<typename K> struct flatHash {
+		static_assert(std::is_integral_v<K>, "flatHash needs an integer or integer vector key");
+		constexpr u64 operator()(const K& k) const { return mix64(u64(k)); };
+	};
+
+	template<typename T> struct flatHash<vector2<T>> {
+		static_assert(std::is_integral_v<T>, "flatHash needs an integer or integer vector key");
+		constexpr u64 operator()(const vector2<T>& k) const {
+			if constexpr (sizeof(T) <= 4) {
+				return mix64((u64(u32(k.x)) << 32) | u32(k.y));
+			}
+			else {
+				return mix64(mix64(u64(k.x)) + u64(k.y));
+			};
+		};
+	};
+
+	template<typename T> struct flatHash<vector3<T>> {
+		static_assert(std::is_integral_v<T>, "flatHash needs an integer or integer vector key");
+		constexpr u64 operator()(const vector3<T>& k) const {
+			return mix64(flatHash<vector2<T>>{}(vector2<T>(k.x, k.y)) + u64(k.z));
+		};
+	};
+
+	// open addressing hash map with SwissTable-style group probing
+	//
+	// every slot has a control byte: empty, deleted, or the low 7 bits of the key's hash; lookups
+	// compare a whole 16 byte group against that tag in one SSE2 compare and only test the keys that
+	// match, and probe further groups (triangular sequence) only while the current group is full.
+	// Entries live inline in one array, so a hit costs one control group and one slot access
+	//
+	// capacity is a power of two, at most 7/8 occupied by entries and tombstones; any insertion or
+	// erase invalidates iterators and references. K and V must be default constructible
+	template<typename K, typename V, typename Hash = flatHash<K>, typename Equal = std::equal_to<K>> class flat_map {
+	public:
+		using key_type = K;
+		using mapped_type = V;
+		using value_type = std::pair<K, V>;
+
+		static constexpr std::size_t group = 16;
+
+	private:
+		static constexpr s8 emptyTag = -128;
+		static constexpr s8 deletedTag = -2;
+		static constexpr std::size_t npos = ~std::size_t(0);
+
+		std::vector<s8> ctrl;
+		std::vector<value_type> slots;
+		std::size_t entries = 0;
+		std::size_t used = 0;
+
+		Hash hasher;
+		Equal equal;
+
+		// bit i set where g[i] == tag
+		static u32 match(const s8* g, s8 tag) {
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+			__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(g));
+			return u32(_mm_movemask_epi8(_mm_cmpeq_epi8(c, _mm_set1_epi8(tag))));
+#else
+			u32 m = 0;
+			for (u32 i = 0; i < group; i++) {
+				m |= u32(g[i] == tag) << i;
+			};
+			return m;
+#endif
+		};
+
+		// bit i set where g[i] is empty or deleted, i.e. has its sign bit set
+		static u32 matchFree(const s8* g) {
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+			return u32(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(g))));
+#else
+			u32 m = 0;
+			for (u32 i = 0; i < group; i++) {
+				m |= u32(g[i] < 0) << i;
+			};
+			return m;
+#endif
+		};
+
+		static s8 tagOf(u64 h) {
+			return s8(h & 0x7f);
+		};
+
+		std::size_t findIndex(const K& key, u64 h) const {
+			if (ctrl.empty()) return npos;
+
+			std::size_t mask = ctrl.size() / group - 1;
+			std::size_t g = std::size_t(h >> 7) & mask;
+			for (std::size_t step = 1;; step++) {
+				const s8* c = ctrl.data() + g * group;
+				for (u32 m = match(c, tagOf(h)); m; m &= m - 1) {
+					std::size_t i = g * group + std::countr_zero(m);
+					if (equal(slots[i].first, key)) return i;
+				};
+				if (match(c, emptyTag)) return npos;
+				g = (g + step) & mask;
+			};
+		};
+
+		// first empty or deleted slot on key's probe sequence
+		std::size_t freeIndex(u64 h) const {
+			std::size_t mask = ctrl.size() / group - 1;
+			std::size_t g = std::size_t(h >> 7) & mask;
+			for (std::size_t step = 1;; step++) {
+				u32 m = matchFree(ctrl.data() + g * group);
+				if (m) return g * group + std::countr_zero(m);
+				g = (g + step) & mask;
+			};
+		};
+
+		void rehash(std::size_t capacity) {
+			std::vector<s8> oldCtrl = std::move(ctrl);
+			std::vector<value_type> oldSlots = std::move(slots);
+			ctrl.assign(capacity, emptyTag);
+			slots.assign(capacity, value_type());
+			used = entries;
+
+			for (std::size_t i = 0; i < oldCtrl.size(); i++) {
+				if (oldCtrl[i] < 0) continue;
+
+				std::size_t j = freeIndex(hasher(oldSlots[i].first));
+				ctrl[j] = oldCtrl[i];
+				slots[j] = std::move(oldSlots[i]);
+			};
+		};
+
+		std::size_t firstFrom(std::size_t i) const {
+			while (i < ctrl.size() && ctrl[i] < 0) i++;
+			return i;
+		};
+
+		template<bool Const> class iteratorT {
+			using owner = std::conditional_t<Const, const flat_map, flat_map>;
+			owner* map;
+			std::size_t index;
+
+		public:
+			using value = std::conditional_t<Const, const value_type, value_type>;
+
+			iteratorT(owner* m, std::size_t i) { map = m; index = i; };
+
+			value& operator*() const { return map->slots[index]; };
+			value* operator->() const { return &map->slots[index]; };
+
+			iteratorT& operator++() {
+				index = map->firstFrom(index + 1);
+				return *this;
+			};
+
+			bool operator==(const iteratorT& b) const { return index == b.index; };
+			bool operator!=(const iteratorT& b) const { return index != b.index; };
+		};
+
+	public:
+		using iterator = iteratorT<false>;
+		using const_iterator = iteratorT<true>;
+
+		flat_map() = default;
+		flat_map(std::size_t n) { reserve(n); };
+
+		std::size_t size() const { return entries; };
+		bool empty() const { return entries == 0; };
+		std::size_t capacity() const { return ctrl.size(); };
+
+		iterator begin() { return iterator(this, firstFrom(0)); };
+		iterator end() { return iterator(this, ctrl.size()); };
+		const_iterator begin() const { return const_iterator(this, firstFrom(0)); };
+		const_iterator end() const { return const_iterator(this, ctrl.size()); };
+
+		// makes room for n entries without rehashing
+		void reserve(std::size_t n) {
+			std::size_t capacity = std::max(group, std::bit_ceil(n + n / 7 + 1));
+			if (capacity > ctrl.size()) rehash(capacity);
+		};
+
+		void clear() {
+			ctrl.clear();
+			slots.clear();
+			entries = 0;
+			used = 0;
+		};
+
+		iterator find(const K& key) {
+			std::size_t i = findIndex(key, hasher(key));
+			return i == npos ? end() : iterator(this, i);
+		};
+		const_iterator find(const K& key) const {
+			std::size_t i = findIndex(key, hasher(key));
+			return i == npos ? end() : const_iterator(this, i);
+		};
+
+		bool contains(const K& key) const {
+			return findIndex(key, hasher(key)) != npos;
+		};
+		std::size_t count(const K& key) const {
+			return contains(key) ? 1 : 0;
+		};
+
+		// inserts V(args...) under key unless key is present; returns the entry and whether it was inserted
+		template<typename... Args> std::pair<iterator, bool> emplace(const K& key, Args&&... args) {
+			u64 h = hasher(key);
+			std::size_t i = findIndex(key, h);
+			if (i != npos) return { iterator(this, i), false };
+
+			if ((used + 1) * 8 > ctrl.size() * 7) {
+				// grow when live entries fill half the table, otherwise only sweep out the tombstones
+				rehash(ctrl.empty() ? group : (entries + 1) * 2 > ctrl.size() ? ctrl.size() * 2 : ctrl.size());
+			};
+
+			i = freeIndex(h);
+			if (ctrl[i] == emptyTag) used++;
+			ctrl[i] = tagOf(h);
+			slots[i] = value_type(key, V(std::forward<Args>(args)...));
+			entries++;
+
+			return { iterator(this, i), true };
+		};
+
+		V& operator[](const K& key) {
+			return emplace(key).first->second;
+		};
+
+		std::size_t erase(const K& key) {
+			std::size_t i = findIndex(key, hasher(key));
+			if (i == npos) return 0;
+
+			// groups are aligned, so a group that still has an empty slot never made a probe move on
+			// and the slot can become empty again instead of a tombstone
+			if (match(ctrl.data() + (i & ~(group - 1)), emptyTag)) {
+				ctrl[i] = emptyTag;
+				used--;
+			}
+			else {
+				ctrl[i] = deletedTag;
+			};
+			slots[i] = value_type();
+			entries--;
+
+			return 1;
+		};
+	};
+};
@@ -0,0 +1,280 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+#include "base.hpp"
+#include "interpolation.hpp"
+#include "vector\vector2.hpp"
+
+namespace nl {
+	// memory order of grid2d cells
+	//   rowMajor - plain rows, for handing the data to code that expects them
+	//   tiled    - Tile x Tile blocks stored one after another, each block row-major
+	//   morton   - the same blocks in Z-order inside each block, so every aligned 2^k x 2^k square
+	//              is contiguous; blocks stay row-major so non power-of-two grids need no padding
+	enum class gridLayout {
+		rowMajor, tiled, morton
+	};
+
+	// moves the low 16 bits of v to the even bit positions
+	constexpr u32 mortonSpread(u32 v) {
+		v &= 0xffff;
+		v = (v | (v << 8)) & 0x00ff00ff;
+		v = (v | (v << 4)) & 0x0f0f0f0f;
+		v = (v | (v << 2)) & 0x33333333;
+		v = (v | (v << 1)) & 0x55555555;
+		return v;
+	};
+
+	constexpr u32 mortonEncode(u32 x, u32 y) {
+		return mortonSpread(x) | (mortonSpread(y) << 1);
+	};
+
+	// width x height cells in a locality-friendly layout; with the default 8 x 8 tiles a 4 x 4
+	// neighbourhood touches at most 4 small blocks instead of 4 rows a whole width apart
+	//
+	// indexing is unchecked; clamped() and the stencils clamp coordinates to the grid, and only
+	// check bounds for cells near the edge
+	template<typename T, gridLayout Layout = gridLayout::tiled, u32 Tile = 8> class grid2d {
+		static_assert(Tile >= 4 && (Tile & (Tile - 1)) == 0, "tile size must be a power of two of at least 4");
+	public:
+		using value_type = T;
+
+		static constexpr u32 tile = Tile;
+		static constexpr u32 shift = std::countr_zero(Tile);
+		static constexpr u32 mask = Tile - 1;
+
+	private:
+		u32 width = 0;
+		u32 height = 0;
+		u32 tilesX = 0;
+		std::vector<T> cells;
+
+		bool isInterior(const s32vec2& c) const {
+			return c.x >= 1 && c.y >= 1 && c.x + 2 < s32(width) && c.y + 2 < s32(height);
+		};
+
+	public:
+		grid2d() = default;
+		grid2d(u32 w, u32 h) { resize(w, h); };
+
+		// discards the contents
+		void resize(u32 w, u32 h) {
+			width = w;
+			height = h;
+			tilesX = (w + mask) >> shift;
+
+			u32 tilesY = (h + mask) >> shift;
+			cells.assign(Layout == gridLayout::rowMajor ? std::size_t(w) * h : (std::size_t(tilesX) * tilesY) << (2 * shift), T());
+		};
+
+		u32 getWidth() const { return width; };
+		u32 getHeight() const { return height; };
+
+		bool contains(const s32vec2& c) const {
+			return c.x >= 0 && c.y >= 0 && c.x < s32(width) && c.y < s32(height);
+		};
+
+		// storage offset of cell (x, y)
+		std::size_t index(s32 x, s32 y) const {
+			if constexpr (Layout == gridLayout::rowMajor) {
+				return std::size_t(y) * width + u32(x);
+			}
+			else {
+				std::size_t block = (std::size_t(u32(y) >> shift) * tilesX + (u32(x) >> shift)) << (2 * shift);
+				if constexpr (Layout == gridLayout::tiled) {
+					return block + ((u32(y) & mask) << shift) + (u32(x) & mask);
+				}
+				else {
+					return block + mortonEncode(u32(x) & mask, u32(y) & mask);
+				};
+			};
+		};
+
+		T& operator[](const s32vec2& c) { return cells[index(c.x, c.y)]; };
+		const T& operator[](const s32vec2& c) const { return cells[index(c.x, c.y)]; };
+
+		T& at(s32 x, s32 y) { return cells[index(x, y)]; };
+		const T& at(s32 x, s32 y) const { return cells[index(x, y)]; };
+
+		const T& clamped(s32 x, s32 y) const {
+			return cells[index(std::clamp(x, 0, s32(width) - 1), std::clamp(y, 0, s32(height) - 1))];
+		};
+
+		// raw storage in layout order, including the padding of partial edge tiles
+		T* data() { return cells.data(); };
+		const T* data() const { return cells.data(); };
+		std::size_t storage() const { return cells.size(); };
+
+		void fill(const T& v) {
+			std::fill(cells.begin(), cells.end(), v);
+		};
+
+		// from / to a row-major width x height buffer
+		void copyFrom(const T* src) {
+			for (u32 y = 0; y < height; y++) {
+				for (u32 x = 0; x < width; x++) {
+					cells[index(x, y)] = src[std::size_t(y) * width + x];
+				};
+			};
+		};
+		void copyTo(T* dst) const {
+			for (u32 y = 0; y < height; y++) {
+				for (u32 x = 0; x < width; x++) {
+					dst[std::size_t(y) * width + x] = cells[index(x, y)];
+				};
+			};
+		};
+
+		// cell (x, y) = the generator at origin + step * (x, y); tiled grids run one fillGrid per tile
+		// straight into storage, morton grids one per tile through a scratch tile
+		template<typename N> void fillFrom(const N& noise, const vector2<typename N::scalar>& origin, const vector2<typename N::scalar>& step) {
+			using S = typename N::scalar;
+
+			if constexpr (Layout == gridLayout::rowMajor) {
+				noise.fillGrid(origin, step, width, height, cells.data());
+			}
+			else {
+				std::vector<S> scratch(Layout == gridLayout::morton ? Tile * Tile : 0);
+
+				for (u32 ty = 0; ty < height; ty += Tile) {
+					for (u32 tx = 0; tx < width; tx += Tile) {
+						vector2<S> corner(origin.x + step.x * S(tx), origin.y + step.y * S(ty));
+						T* block = cells.data() + index(tx, ty);
+
+						if constexpr (Layout == gridLayout::tiled) {
+							noise.fillGrid(corner, step, Tile, Tile, block);
+						}
+						else {
+							noise.fillGrid(corner, step, Tile, Tile, scratch.data());
+							for (u32 y = 0; y < Tile; y++) {
+								for (u32 x = 0; x < Tile; x++) {
+									block[mortonEncode(x, y)] = scratch[y * Tile + x];
+								};
+							};
+						};
+					};
+				};
+			};
+		};
+
+		// the 4 x 4 cells around c, out[(dy + 1) * 4 + (dx + 1)] for dx, dy in [-1, 2], the order of the
+		// lattice stencils and bicubicInterpolation; cells beyond the edge repeat the edge
+		void stencil(const s32vec2& c, T* out) const {
+			if (!isInterior(c)) {
+				for (s32 dy = -1; dy <= 2; dy++) {
+					for (s32 dx = -1; dx <= 2; dx++) {
+						out[(dy + 1) * 4 + (dx + 1)] = clamped(c.x + dx, c.y + dy);
+					};
+				};
+				return;
+			};
+
+			// four rows of four contiguous cells whenever the window sits inside one row-major block
+			if constexpr (Layout != gridLayout::morton) {
+				u32 stride = Layout == gridLayout::rowMajor ? width : Tile;
+				if (Layout == gridLayout::rowMajor || ((u32(c.x - 1) & mask) <= mask - 3 && (u32(c.y - 1) & mask) <= mask - 3)) {
+					const T* p = cells.data() + index(c.x - 1, c.y - 1);
+					for (u32 r = 0; r < 4; r++) {
+						std::copy_n(p + std::size_t(r) * stride, 4, out + r * 4);
+					};
+					return;
+				};
+			};
+
+			for (s32 dy = -1; dy <= 2; dy++) {
+				for (s32 dx = -1; dx <= 2; dx++) {
+					out[(dy + 1) * 4 + (dx + 1)] = cells[index(c.x + dx, c.y + dy)];
+				};
+			};
+		};
+
+		// visits the stencil of every cell in row order; stepping along a row shifts the window and
+		// reads only the 4 cells of the column that came into view
+		class stencilIterator {
+			const grid2d* grid;
+			s32vec2 c;
+			T window[16];
+
+			void load() {
+				if (c.y < s32(grid->height)) grid->stencil(c, window);
+			};
+
+		public:
+			stencilIterator(const grid2d* g, const s32vec2& start) {
+				grid = g;
+				c = start;
+				load();
+			};
+
+			const s32vec2& cell() const { return c; };
+			const T* operator*() const { return window; };
+
+			stencilIterator& operator++() {
+				if (++c.x >= s32(grid->width)) {
+					c.x = 0;
+					c.y++;
+					load();
+					return *this;
+				};
+
+				for (u32 r = 0; r < 4; r++) {
+					window[r * 4] = window[r * 4 + 1];
+					window[r * 4 + 1] = window[r * 4 + 2];
+					window[r * 4 + 2] = window[r * 4 + 3];
+				};
+
+				s32 x = c.x + 2;
+				if (x < s32(grid->width) && c.y >= 1 && c.y + 2 < s32(grid->height)) {
+					for (s32 r = 0; r < 4; r++) {
+						window[r * 4 + 3] = grid->cells[grid->index(x, c.y - 1 + r)];
+					};
+				}
+				else {
+					for (s32 r = 0; r < 4; r++) {
+						window[r * 4 + 3] = grid->clamped(x, c.y - 1 + r);
+					};
+				};
+				return *this;
+			};
+
+			bool operator==(const stencilIterator& b) const { return c.x == b.c.x && c.y == b.c.y; };
+			bool operator!=(const stencilIterator& b) const { return !(*this == b); };
+		};
+
+		struct stencilRange {
+			stencilIterator first;
+			stencilIterator last;
+
+			stencilIterator begin() const { return first; };
+			stencilIterator end() const { return last; };
+		};
+
+		stencilIterator stencilBegin() const {
+			return width == 0 ? stencilEnd() : stencilIterator(this, s32vec2(0, 0));
+		};
+		stencilIterator stencilEnd() const {
+			return stencilIterator(this, s32vec2(0, s32(height)));
+		};
+
+		// for (const T* s : grid.stencils()) ...
+		stencilRange stencils() const {
+			return { stencilBegin(), stencilEnd() };
+		};
+
+		// bicubic interpolation of the cell values at a fractional cell position, edges clamped
+		T sample(const vector2<T>& pos) const {
+			s32vec2 c(std::floor(pos.x), std::floor(pos.y));
+
+			T s[16];
+			stencil(c, s);
+			return bicubicInterpolation(
+				s[0], s[1], s[2], s[3],
+				s[4], s[5], s[6], s[7],
+				s[8], s[9], s[10], s[11],
+				s[12], s[13], s[14], s[15], vector2<T>{ fraction(pos.x), fraction(pos.y) });
+		};
+	};
+};
@@ -1,30 +1,95 @@
 #pragma once
 
+#include <type_traits>
+
 #include "vector\vector2.hpp"
 
 namespace nl {
+	// quintic is "improved" Perlin blending: the 4 surrounding lattice points weighted by the C2
+	// fade curve 6t^5 - 15t^4 + 10t^3 instead of the 16 point Hermite stencil of cubic
 	enum class interpolation {
-		nearest, linear, cubic
+		nearest, linear, cubic, quintic
+	};
+
+	// calls f(std::integral_constant<interpolation, ip>{}) so a runtime mode can select a
+	// compile-time specialised code path once, outside of any per-sample loop
+	template<typename F> constexpr decltype(auto) withInterpolation(const interpolation& ip, F&& f) {
+		switch (ip) {
+		case(interpolation::nearest):
+			return f(std::integral_constant<interpolation, interpolation::nearest>{});
+			break;
+		case(interpolation::linear):
+			return f(std::integral_constant<interpolation, interpolation::linear>{});
+			break;
+		case(interpolation::quintic):
+			return f(std::integral_constant<interpolation, interpolation::quintic>{});
+			break;
+		default:
+			return f(std::integral_constant<interpolation, interpolation::cubic>{});
+			break;
+		};
+	};
+
+	// a value together with its partial derivatives along x and y; the arithmetic applies the sum,
+	// product and quotient rules, so running the interpolation functions below on gradientPoint<T>
+	// returns the interpolated value and its analytic gradient (Hermite terms included) in one pass
+	template<typename T> struct gradientPoint {
+		T value = 0;
+		T dx = 0;
+		T dy = 0;
+
+		constexpr gradientPoint() = default;
+		constexpr gradientPoint(T v) { value = v; };
+		constexpr gradientPoint(T v, T x, T y) { value = v; dx = x; dy = y; };
+
+		constexpr vector2<T> gradient() const { return vector2<T>(dx, dy); };
+
+		constexpr gradientPoint operator-() const { return gradientPoint(-value, -dx, -dy); };
+
+		constexpr gradientPoint& operator+=(const gradientPoint& b) { value += b.value; dx += b.dx; dy += b.dy; return *this; };
+		constexpr gradientPoint& operator-=(const gradientPoint& b) { value -= b.value; dx -= b.dx; dy -= b.dy; return *this; };
+		constexpr gradientPoint& operator*=(const gradientPoint& b) { return *this = *this * b; };
+		constexpr gradientPoint& operator/=(const gradientPoint& b) { return *this = *this / b; };
+
+		friend constexpr gradientPoint operator+(gradientPoint a, const gradientPoint& b) { return a += b; };
+		friend constexpr gradientPoint operator-(gradientPoint a, const gradientPoint& b) { return a -= b; };
+
+		friend constexpr gradientPoint operator*(const gradientPoint& a, const gradientPoint& b) {
+			return gradientPoint(a.value * b.value, a.dx * b.value + a.value * b.dx, a.dy * b.value + a.value * b.dy);
+		};
+		friend constexpr gradientPoint operator*(const gradientPoint& a, T s) { return gradientPoint(a.value * s, a.dx * s, a.dy * s); };
+		friend constexpr gradientPoint operator*(T s, const gradientPoint& a) { return gradientPoint(s * a.value, s * a.dx, s * a.dy); };
+
+		friend constexpr gradientPoint operator/(const gradientPoint& a, const gradientPoint& b) {
+			T q = a.value / b.value;
+			return gradientPoint(q, (a.dx - q * b.dx) / b.value, (a.dy - q * b.dy) / b.value);
+		};
+		friend constexpr gradientPoint operator/(const gradientPoint& a, T s) { return gradientPoint(a.value / s, a.dx / s, a.dy / s); };
+
+		friend constexpr gradientPoint operator+(const gradientPoint& a, T s) { return gradientPoint(a.value + s, a.dx, a.dy); };
+		friend constexpr gradientPoint operator-(const gradientPoint& a, T s) { return gradientPoint(a.value - s, a.dx, a.dy); };
 	};
 
-	constexpr f64 linearInterpolation(f64 a, f64 b, f64 pos, f64 range) {
+	// every interpolation function is templated on the scalar type, so the f32 noise pipeline
+	// runs in single precision end to end; the f64 instantiations are the reference results
+	template<typename T> constexpr T linearInterpolation(T a, T b, T pos, T range) {
 		return a + (b - a) * (pos / range);
 	};
-	constexpr f64 linearInterpolation(f64 a, f64 b, f64 pos) {
-		return linearInterpolation(a, b, pos, 1.0f);
+	template<typename T> constexpr T linearInterpolation(T a, T b, T pos) {
+		return linearInterpolation(a, b, pos, T(1));
 	};
 
-	constexpr f64 bilinearInterpolation(f64 aa, f64 ba, f64 ab, f64 bb, const f64vec2& pos, const f64vec2& range) {
-		f64 ia = linearInterpolation(aa, ba, pos.x, range.x);
-		f64 ib = linearInterpolation(ab, bb, pos.y, range.y);
+	template<typename T> constexpr T bilinearInterpolation(T aa, T ba, T ab, T bb, const vector2<T>& pos, const vector2<T>& range) {
+		T ia = linearInterpolation(aa, ba, pos.x, range.x);
+		T ib = linearInterpolation(ab, bb, pos.y, range.y);
 
 		return linearInterpolation(ia, ib, pos.x, range.y);
 	};
-	constexpr f64 bilinearInterpolation(f64 aa, f64 ba, f64 ab, f64 bb, const f64vec2& pos, f64 range) {
-		return bilinearInterpolation(aa, ba, ab, bb, pos, f64vec2(range));
+	template<typename T> constexpr T bilinearInterpolation(T aa, T ba, T ab, T bb, const vector2<T>& pos, T range) {
+		return bilinearInterpolation(aa, ba, ab, bb, pos, vector2<T>(range));
 	};
-	constexpr f64 bilinearInterpolation(f64 aa, f64 ba, f64 ab, f64 bb, const f64vec2& pos) {
-		return bilinearInterpolation(aa, ba, ab, bb, pos, f64vec2(1.0f));
+	template<typename T> constexpr T bilinearInterpolation(T aa, T ba, T ab, T bb, const vector2<T>& pos) {
+		return bilinearInterpolation(aa, ba, ab, bb, pos, vector2<T>(T(1)));
 	};
 
 	/*constexpr f64 trilinearInterpolation(f64 aaa, f64 baa, f64 aba, f64 bba, f64 aab, f64 bab, f64 abb, f64 bbb, const vec3<float>& pos, const vec3<float>& range) {
@@ -40,47 +105,71 @@ namespace nl {
 		return trilinearInterpolation(aaa, baa, aba, bba, aab, bab, abb, bbb, pos, 1.0f);
 	};*/
 
-	constexpr f64 cubicInterpolation(f64 a, f64 b, f64 c, f64 d, f64 pos, f64 range) {
+	template<typename T> constexpr T cubicInterpolation(T a, T b, T c, T d, T pos, T range) {
 		pos /= range;
 
-		f64 p0 = b * (2.0f * pos * pos * pos - 3.0f * pos * pos + 1.0f);
-		f64 m0 = (c - a) / 2.0f * (pos * pos * pos - 2.0f * pos * pos + pos);
-		f64 p1 = c * (-2.0f * pos * pos * pos + 3 * pos * pos);
-		f64 m1 = (d - b) / 2.0f * (pos * pos * pos - pos * pos);
+		T p0 = b * (2.0f * pos * pos * pos - 3.0f * pos * pos + 1.0f);
+		T m0 = (c - a) / 2.0f * (pos * pos * pos - 2.0f * pos * pos + pos);
+		T p1 = c * (-2.0f * pos * pos * pos + 3 * pos * pos);
+		T m1 = (d - b) / 2.0f * (pos * pos * pos - pos * pos);
 
 		return p0 + m0 + p1 + m1;
 	};
-	constexpr f64 cubicInterpolation(f64 a, f64 b, f64 c, f64 d, f64 pos) {
-		return cubicInterpolation(a, b, c, d, pos, 1.0f);
+	template<typename T> constexpr T cubicInterpolation(T a, T b, T c, T d, T pos) {
+		return cubicInterpolation(a, b, c, d, pos, T(1));
 	};
 
-	constexpr f64 bicubicInterpolation(
-		f64 aa, f64 ba, f64 ca, f64 da,
-		f64 ab, f64 bb, f64 cb, f64 db,
-		f64 ac, f64 bc, f64 cc, f64 dc,
-		f64 ad, f64 bd, f64 cd, f64 dd,
-		const f64vec2& pos, const f64vec2& range) {
-		f64 ia = cubicInterpolation(aa, ba, ca, da, pos.x, range.x);
-		f64 ib = cubicInterpolation(ab, bb, cb, db, pos.x, range.x);
-		f64 ic = cubicInterpolation(ac, bc, cc, dc, pos.x, range.x);
-		f64 id = cubicInterpolation(ad, bd, cd, dd, pos.x, range.x);
+	template<typename T> constexpr T bicubicInterpolation(
+		T aa, T ba, T ca, T da,
+		T ab, T bb, T cb, T db,
+		T ac, T bc, T cc, T dc,
+		T ad, T bd, T cd, T dd,
+		const vector2<T>& pos, const vector2<T>& range) {
+		T ia = cubicInterpolation(aa, ba, ca, da, pos.x, range.x);
+		T ib = cubicInterpolation(ab, bb, cb, db, pos.x, range.x);
+		T ic = cubicInterpolation(ac, bc, cc, dc, pos.x, range.x);
+		T id = cubicInterpolation(ad, bd, cd, dd, pos.x, range.x);
 
 		return cubicInterpolation(ia, ib, ic, id, pos.y, range.y);
 	};
-	constexpr f64 bicubicInterpolation(
-		f64 aa, f64 ba, f64 ca, f64 da,
-		f64 ab, f64 bb, f64 cb, f64 db,
-		f64 ac, f64 bc, f64 cc, f64 dc,
-		f64 ad, f64 bd, f64 cd, f64 dd,
-		const f64vec2& pos, f64 range) {
-		return bicubicInterpolation(aa, ba, ca, da, ab, bb, cb, db, ac, bc, cc, dc, ad, bd, cd, dd, pos, f64vec2(range));
-	};
-	constexpr f64 bicubicInterpolation(
-		f64 aa, f64 ba, f64 ca, f64 da,
-		f64 ab, f64 bb, f64 cb, f64 db,
-		f64 ac, f64 bc, f64 cc, f64 dc,
-		f64 ad, f64 bd, f64 cd, f64 dd,
-		const f64vec2& pos) {
-		return bicubicInterpolation(aa, ba, ca, da, ab, bb, cb, db, ac, bc, cc, dc, ad, bd, cd, dd, pos, 1.0f);
+	template<typename T> constexpr T bicubicInterpolation(
+		T aa, T ba, T ca, T da,
+		T ab, T bb, T cb, T db,
+		T ac, T bc, T cc, T dc,
+		T ad, T bd, T cd, T dd,
+		const vector2<T>& pos, T range) {
+		return bicubicInterpolation(aa, ba, ca, da, ab, bb, cb, db, ac, bc, cc, dc, ad, bd, cd, dd, pos, vector2<T>(range));
+	};
+	template<typename T> constexpr T bicubicInterpolation(
+		T aa, T ba, T ca, T da,
+		T ab, T bb, T cb, T db,
+		T ac, T bc, T cc, T dc,
+		T ad, T bd, T cd, T dd,
+		const vector2<T>& pos) {
+		return bicubicInterpolation(aa, ba, ca, da, ab, bb, cb, db, ac, bc, cc, dc, ad, bd, cd, dd, pos, T(1));
+	};
+
+	template<typename T> constexpr T quinticFade(T pos) {
+		return pos * pos * pos * (pos * (pos * T(6) - T(15)) + T(10));
+	};
+
+	template<typename T> constexpr T quinticInterpolation(T a, T b, T pos, T range) {
+		return a + (b - a) * quinticFade(pos / range);
+	};
+	template<typename T> constexpr T quinticInterpolation(T a, T b, T pos) {
+		return quinticInterpolation(a, b, pos, T(1));
+	};
+
+	template<typename T> constexpr T biquinticInterpolation(T aa, T ba, T ab, T bb, const vector2<T>& pos, const vector2<T>& range) {
+		T ia = quinticInterpolation(aa, ba, pos.x, range.x);
+		T ib = quinticInterpolation(ab, bb, pos.x, range.x);
+
+		return quinticInterpolation(ia, ib, pos.y, range.y);
+	};
+	template<typename T> constexpr T biquinticInterpolation(T aa, T ba, T ab, T bb, const vector2<T>& pos, T range) {
+		return biquinticInterpolation(aa, ba, ab, bb, pos, vector2<T>(range));
+	};
+	template<typename T> constexpr T biquinticInterpolation(T aa, T ba, T ab, T bb, const vector2<T>& pos) {
+		return biquinticInterpolation(aa, ba, ab, bb, pos, vector2<T>(T(1)));
 	};
 };
\ No newline at end of file
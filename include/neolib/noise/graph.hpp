@@ -0,0 +1,389 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "..\math.hpp"
+#include "..\vector\vector2.hpp"
+#include "perlin.hpp"
+
+namespace nl {
+	// a field built from noise generators and operations on them, evaluated in one fused pass
+	//
+	// nodes are added through the builder functions and referred to by the returned handle; compile(root)
+	// flattens everything root depends on into a register program, which getPoints / fillGrid then run
+	// over chunks of at most chunk samples, so every intermediate lives in a chunk-sized buffer that
+	// stays in L1 instead of a full-size temporary per node. Sampling a graph that was never compiled
+	// asserts, and yields zeros where asserts are compiled out
+	//
+	// warp(target, dx, dy, strength) samples target at (x + strength * dx, y + strength * dy); it is
+	// compiled by re-emitting target against the displaced coordinates, so a subgraph reached through
+	// several different warps is evaluated once per distinct coordinate pair
+	//
+	// sources are referenced, not copied, and may be any generator with getPoints and isConcurrent,
+	// including another graph. One that also has scratchSize(count) and getPoints(xs, ys, count, out,
+	// scratch) is handed scratch from the buffer getPoints / fillGrid allocate once per call, so
+	// sampling it chunk by chunk allocates nothing
+	template<typename T = f64> class graph2dT {
+	public:
+		using scalar = T;
+		using vec2 = vector2<T>;
+		using node = u32;
+
+		static constexpr u32 chunk = 64;
+
+	private:
+		enum class op {
+			x, y, constant, source, add, sub, mul, min, max, blend, offset, remap, contour, warp
+		};
+
+		// a node as built; for warp a is the target and b, c the displacements
+		struct definition {
+			op code;
+			node a = 0;
+			node b = 0;
+			node c = 0;
+			T k[4] = {};
+			u32 source = 0;
+		};
+
+		// a program step on registers of chunk samples each
+		struct instruction {
+			op code;
+			u32 dst = 0;
+			u32 a = 0;
+			u32 b = 0;
+			u32 c = 0;
+			T k[4] = {};
+			u32 source = 0;
+		};
+
+		struct sourceRef {
+			std::function<void(const T*, const T*, std::size_t, T*, T*)> sample;
+			std::function<bool()> concurrent;
+			std::function<std::size_t()> scratch;
+		};
+
+		std::vector<definition> nodes;
+		std::vector<sourceRef> sources;
+
+		std::vector<instruction> program;
+		u32 registers = 2;
+		u32 result = 0;
+		bool compiled = false;
+
+		node push(const definition& d) {
+			nodes.push_back(d);
+			return node(nodes.size() - 1);
+		};
+
+		// emits n evaluated at the coordinates in virtual registers cx, cy and returns its virtual register
+		u32 emit(node n, u32 cx, u32 cy, std::vector<instruction>& code, std::map<std::tuple<node, u32, u32>, u32>& emitted, u32& next) const {
+			const definition& d = nodes[n];
+			if (d.code == op::x) return cx;
+			if (d.code == op::y) return cy;
+
+			auto key = std::make_tuple(n, cx, cy);
+			auto it = emitted.find(key);
+			if (it != emitted.end()) return it->second;
+
+			instruction in;
+			in.code = d.code;
+			std::copy_n(d.k, 4, in.k);
+			in.source = d.source;
+
+			switch (d.code) {
+			case(op::constant):
+				break;
+			case(op::source):
+				in.a = cx;
+				in.b = cy;
+				break;
+			case(op::warp): {
+				u32 dx = emit(d.b, cx, cy, code, emitted, next);
+				u32 dy = emit(d.c, cx, cy, code, emitted, next);
+
+				instruction wx{ op::offset, next++, cx, dx };
+				instruction wy{ op::offset, next++, cy, dy };
+				wx.k[0] = d.k[0];
+				wy.k[0] = d.k[0];
+				code.push_back(wx);
+				code.push_back(wy);
+
+				u32 res = emit(d.a, wx.dst, wy.dst, code, emitted, next);
+				emitted[key] = res;
+				return res;
+			}
+			case(op::remap):
+			case(op::contour):
+				in.a = emit(d.a, cx, cy, code, emitted, next);
+				break;
+			case(op::blend):
+				in.c = emit(d.c, cx, cy, code, emitted, next);
+				[[fallthrough]];
+			default:
+				in.a = emit(d.a, cx, cy, code, emitted, next);
+				in.b = emit(d.b, cx, cy, code, emitted, next);
+				break;
+			};
+
+			in.dst = next++;
+			code.push_back(in);
+			emitted[key] = in.dst;
+			return in.dst;
+		};
+
+		// chunk registers followed by the largest scratch a source asks for
+		std::size_t bufferSize() const {
+			std::size_t res = 0;
+			for (const sourceRef& s : sources) {
+				res = std::max(res, s.scratch());
+			};
+			return std::size_t(registers) * chunk + res;
+		};
+
+		// runs the program over count <= chunk samples whose coordinates are in registers 0 and 1
+		void run(T* regs, std::size_t count) const {
+			T* scratch = regs + std::size_t(registers) * chunk;
+			for (const instruction& in : program) {
+				T* d = regs + std::size_t(in.dst) * chunk;
+				const T* a = regs + std::size_t(in.a) * chunk;
+				const T* b = regs + std::size_t(in.b) * chunk;
+				const T* c = regs + std::size_t(in.c) * chunk;
+
+				switch (in.code) {
+				case(op::constant):
+					std::fill(d, d + count, in.k[0]);
+					break;
+				case(op::source):
+					sources[in.source].sample(a, b, count, d, scratch);
+					break;
+				case(op::add):
+					for (std::size_t i = 0; i < count; i++) d[i] = a[i] + b[i];
+					break;
+				case(op::sub):
+					for (std::size_t i = 0; i < count; i++) d[i] = a[i] - b[i];
+					break;
+				case(op::mul):
+					for (std::size_t i = 0; i < count; i++) d[i] = a[i] * b[i];
+					break;
+				case(op::min):
+					for (std::size_t i = 0; i < count; i++) d[i] = std::min(a[i], b[i]);
+					break;
+				case(op::max):
+					for (std::size_t i = 0; i < count; i++) d[i] = std::max(a[i], b[i]);
+					break;
+				case(op::blend):
+					for (std::size_t i = 0; i < count; i++) d[i] = a[i] + (b[i] - a[i]) * c[i];
+					break;
+				case(op::offset):
+					for (std::size_t i = 0; i < count; i++) d[i] = a[i] + in.k[0] * b[i];
+					break;
+				case(op::remap):
+					for (std::size_t i = 0; i < count; i++) d[i] = map(a[i], in.k[0], in.k[1], in.k[2], in.k[3]);
+					break;
+				case(op::contour):
+					for (std::size_t i = 0; i < count; i++) d[i] = std::abs(a[i] - in.k[0]);
+					break;
+				default:
+					break;
+				};
+			};
+		};
+
+	public:
+		// the sample coordinates themselves
+		node x() { return push({ op::x }); };
+		node y() { return push({ op::y }); };
+
+		node constant(T v) {
+			definition d{ op::constant };
+			d.k[0] = v;
+			return push(d);
+		};
+
+		template<typename N> node source(const N& n) {
+			if constexpr (requires(T* p) { n.scratchSize(std::size_t(chunk)); n.getPoints(p, p, std::size_t(chunk), p, p); }) {
+				sources.push_back({
+					[&n](const T* xs, const T* ys, std::size_t count, T* out, T* scratch) { n.getPoints(xs, ys, count, out, scratch); },
+					[&n] { return n.isConcurrent(); },
+					[&n] { return std::size_t(n.scratchSize(chunk)); }
+				});
+			}
+			else {
+				sources.push_back({
+					[&n](const T* xs, const T* ys, std::size_t count, T* out, T*) { n.getPoints(xs, ys, count, out); },
+					[&n] { return n.isConcurrent(); },
+					[] { return std::size_t(0); }
+				});
+			};
+
+			definition d{ op::source };
+			d.source = u32(sources.size() - 1);
+			return push(d);
+		};
+
+		node add(node a, node b) { return push({ op::add, a, b }); };
+		node sub(node a, node b) { return push({ op::sub, a, b }); };
+		node mul(node a, node b) { return push({ op::mul, a, b }); };
+		node min(node a, node b) { return push({ op::min, a, b }); };
+		node max(node a, node b) { return push({ op::max, a, b }); };
+
+		// a where t is 0, b where t is 1, linear in between
+		node blend(node a, node b, node t) { return push({ op::blend, a, b, t }); };
+
+		node warp(node target, node dx, node dy, T strength = T(1)) {
+			definition d{ op::warp, target, dx, dy };
+			d.k[0] = strength;
+			return push(d);
+		};
+
+		// maps [minin, maxin] onto [minout, maxout], e.g. with an additive2d's range to normalise it
+		node remap(node a, T minin, T maxin, T minout = T(-1), T maxout = T(1)) {
+			definition d{ op::remap, a };
+			d.k[0] = minin;
+			d.k[1] = maxin;
+			d.k[2] = minout;
+			d.k[3] = maxout;
+			return push(d);
+		};
+
+		// |a - level|, the additive2d contour transform
+		node contour(node a, T level) {
+			definition d{ op::contour, a };
+			d.k[0] = level;
+			return push(d);
+		};
+
+		// builds the program evaluating root; must be called again after adding nodes root depends on
+		void compile(node root) {
+			std::vector<instruction> code;
+			std::map<std::tuple<node, u32, u32>, u32> emitted;
+			u32 next = 2;
+			u32 res = emit(root, 0, 1, code, emitted, next);
+
+			// last instruction reading each virtual register; the coordinates and the result are never freed
+			std::vector<std::size_t> last(next, 0);
+			for (std::size_t i = 0; i < code.size(); i++) {
+				last[code[i].a] = i;
+				last[code[i].b] = i;
+				last[code[i].c] = i;
+			};
+			last[0] = last[1] = last[res] = code.size();
+
+			// linear scan: a register is reused once every reader has run; the destination is picked
+			// before the operands are released, so no instruction writes a register it still reads
+			std::vector<u32> slot(next, 0);
+			std::vector<u32> free;
+			slot[1] = 1;
+			u32 count = 2;
+
+			for (std::size_t i = 0; i < code.size(); i++) {
+				instruction& in = code[i];
+				u32 v = in.dst;
+				if (free.empty()) {
+					slot[v] = count++;
+				}
+				else {
+					slot[v] = free.back();
+					free.pop_back();
+				};
+
+				for (u32 operand : { in.a, in.b, in.c }) {
+					if (last[operand] == i) {
+						free.push_back(slot[operand]);
+						last[operand] = code.size();
+					};
+				};
+
+				in.dst = slot[v];
+				in.a = slot[in.a];
+				in.b = slot[in.b];
+				in.c = slot[in.c];
+			};
+
+			program = code;
+			registers = count;
+			result = slot[res];
+			compiled = true;
+		};
+
+		bool isCompiled() const { return compiled; };
+
+		// instructions and chunk registers in the compiled program
+		std::size_t instructions() const { return program.size(); };
+		u32 registerCount() const { return registers; };
+
+		bool isConcurrent() const {
+			return std::all_of(sources.begin(), sources.end(), [](const sourceRef& s) { return s.concurrent(); });
+		};
+
+		// scalars of scratch getPoints works in, whatever the count
+		std::size_t scratchSize(std::size_t) const {
+			return bufferSize();
+		};
+
+		// out[i] = the compiled root at { xs[i], ys[i] }; scratch holds scratchSize(count) scalars
+		void getPoints(const T* xs, const T* ys, std::size_t count, T* out, T* scratch) const {
+			assert(compiled && "graph2dT sampled before compile()");
+			if (!compiled) {
+				std::fill_n(out, count, T(0));
+				return;
+			};
+
+			for (std::size_t i = 0; i < count; i += chunk) {
+				std::size_t n = std::min<std::size_t>(chunk, count - i);
+				std::copy_n(xs + i, n, scratch);
+				std::copy_n(ys + i, n, scratch + chunk);
+
+				run(scratch, n);
+				std::copy_n(scratch + std::size_t(result) * chunk, n, out + i);
+			};
+		};
+
+		void getPoints(const T* xs, const T* ys, std::size_t count, T* out) const {
+			std::vector<T> regs(bufferSize());
+			getPoints(xs, ys, count, out, regs.data());
+		};
+
+		T getPoint(const vec2& coord) const {
+			T res;
+			getPoints(&coord.x, &coord.y, 1, &res);
+			return res;
+		};
+
+		// same layout as base2d::fillGrid
+		void fillGrid(const vec2& origin, const vec2& step, u32 width, u32 height, T* out) const {
+			assert(compiled && "graph2dT sampled before compile()");
+			if (!compiled) {
+				std::fill_n(out, std::size_t(width) * height, T(0));
+				return;
+			};
+
+			std::vector<T> regs(bufferSize());
+
+			for (u32 j = 0; j < height; j++) {
+				T y = origin.y + step.y * T(j);
+
+				for (u32 i = 0; i < width; i += chunk) {
+					u32 n = std::min(chunk, width - i);
+					for (u32 k = 0; k < n; k++) {
+						regs[k] = origin.x + step.x * T(i + k);
+					};
+					std::fill_n(regs.data() + chunk, n, y);
+
+					run(regs.data(), n);
+					std::copy_n(regs.data() + std::size_t(result) * chunk, n, out + std::size_t(j) * width + i);
+				};
+			};
+		};
+	};
+
+	using graph2d = graph2dT<f64>;
+	using f32graph2d = graph2dT<f32>;
+	using f64graph2d = graph2dT<f64>;
+};
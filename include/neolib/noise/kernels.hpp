@@ -0,0 +1,174 @@
+#pragma once
+
+#include "..\simd.hpp"
+#include "..\interpolation.hpp"
+#include "lattice.hpp"
+
+namespace nl {
+	// batch evaluation of lattice::hashed noise, simd::pack<T, W>::width points per step, in f64 or f32
+	//
+	// every kernel repeats the scalar getPoint arithmetic operation for operation, so results are
+	// bit-identical to the scalar path unless the compiler contracts mul/add pairs into FMAs
+	// (/fp:contract, -ffp-contract=fast); the difference is then bounded by 1e-12 absolute
+	namespace kernels {
+		template<typename P> P cubic(const P& a, const P& b, const P& c, const P& d, const P& pos) {
+			using T = typename P::scalar;
+			P pos2 = pos * pos;
+			P pos3 = pos2 * pos;
+
+			P p0 = b * (P::broadcast(T(2.0)) * pos * pos * pos - P::broadcast(T(3.0)) * pos * pos + P::broadcast(T(1.0)));
+			P m0 = (c - a) * P::broadcast(T(0.5)) * (pos3 - P::broadcast(T(2.0)) * pos * pos + pos);
+			P p1 = c * (P::broadcast(T(-2.0)) * pos * pos * pos + P::broadcast(T(3.0)) * pos * pos);
+			P m1 = (d - b) * P::broadcast(T(0.5)) * (pos3 - pos2);
+
+			return p0 + m0 + p1 + m1;
+		};
+
+		template<typename P> P bilinear(const P& aa, const P& ba, const P& ab, const P& bb, const P& fx, const P& fy) {
+			P ia = aa + (ba - aa) * fx;
+			P ib = ab + (bb - ab) * fy;
+
+			return ia + (ib - ia) * fx;
+		};
+
+		template<typename P> P quinticFade(const P& pos) {
+			using T = typename P::scalar;
+			return pos * pos * pos * (pos * (pos * P::broadcast(T(6.0)) - P::broadcast(T(15.0))) + P::broadcast(T(10.0)));
+		};
+
+		template<typename P> P biquintic(const P& aa, const P& ba, const P& ab, const P& bb, const P& fx, const P& fy) {
+			P wx = quinticFade(fx);
+			P ia = aa + (ba - aa) * wx;
+			P ib = ab + (bb - ab) * wx;
+
+			return ia + (ib - ia) * quinticFade(fy);
+		};
+
+		template<typename P> P perlinCorner(const P& x, const P& y, const P& ix, const P& iy, const typename P::index& hx, const typename P::index& hy, s32 dx, s32 dy, u32 seed) {
+			using U = typename P::index;
+			using T = typename P::scalar;
+			const gradientComponents<T>& table = gradientTableSoA<T>();
+
+			U h = latticeHash(hx + U::broadcast(u32(dx)), hy + U::broadcast(u32(dy)), seed) & U::broadcast(gradientCount - 1);
+			P gx = P::gather(table.x.data(), h);
+			P gy = P::gather(table.y.data(), h);
+
+			P deltax = (x - (ix + P::broadcast(T(dx)))) * P::broadcast(T(2.0));
+			P deltay = (y - (iy + P::broadcast(T(dy)))) * P::broadcast(T(2.0));
+			return deltax * gx + deltay * gy;
+		};
+
+		template<interpolation M, typename P> P perlinPoint(const P& x, const P& y, u32 seed) {
+			P ix = x.floor();
+			P iy = y.floor();
+			P fx = x - ix;
+			P fy = y - iy;
+			typename P::index hx = ix.toIndex();
+			typename P::index hy = iy.toIndex();
+
+			if constexpr (M == interpolation::nearest) {
+				return perlinCorner(ix, iy, ix, iy, hx, hy, 0, 0, seed);
+			}
+			else if constexpr (M == interpolation::linear) {
+				return bilinear(
+					perlinCorner(x, y, ix, iy, hx, hy, 0, 0, seed),
+					perlinCorner(x, y, ix, iy, hx, hy, 1, 0, seed),
+					perlinCorner(x, y, ix, iy, hx, hy, 0, 1, seed),
+					perlinCorner(x, y, ix, iy, hx, hy, 1, 1, seed), fx, fy);
+			}
+			else if constexpr (M == interpolation::quintic) {
+				return biquintic(
+					perlinCorner(x, y, ix, iy, hx, hy, 0, 0, seed),
+					perlinCorner(x, y, ix, iy, hx, hy, 1, 0, seed),
+					perlinCorner(x, y, ix, iy, hx, hy, 0, 1, seed),
+					perlinCorner(x, y, ix, iy, hx, hy, 1, 1, seed), fx, fy);
+			}
+			else {
+				P rows[4];
+				for (s32 dy = -1; dy <= 2; dy++) {
+					rows[dy + 1] = cubic(
+						perlinCorner(x, y, ix, iy, hx, hy, -1, dy, seed),
+						perlinCorner(x, y, ix, iy, hx, hy, 0, dy, seed),
+						perlinCorner(x, y, ix, iy, hx, hy, 1, dy, seed),
+						perlinCorner(x, y, ix, iy, hx, hy, 2, dy, seed), fx);
+				};
+				return cubic(rows[0], rows[1], rows[2], rows[3], fy);
+			};
+		};
+
+		template<typename P> P valueCorner(const typename P::index& hx, const typename P::index& hy, s32 dx, s32 dy, u32 seed) {
+			using U = typename P::index;
+
+			U h = latticeHash(hx + U::broadcast(u32(dx)), hy + U::broadcast(u32(dy)), seed);
+			return P::fromUnsigned(h) * P::broadcast(typename P::scalar(1.0 / 4294967296.0));
+		};
+
+		template<interpolation M, typename P> P valuePoint(const P& x, const P& y, u32 seed) {
+			P ix = x.floor();
+			P iy = y.floor();
+			P fx = x - ix;
+			P fy = y - iy;
+			typename P::index hx = ix.toIndex();
+			typename P::index hy = iy.toIndex();
+
+			if constexpr (M == interpolation::nearest) {
+				return valueCorner<P>(hx, hy, 0, 0, seed);
+			}
+			else if constexpr (M == interpolation::linear) {
+				return bilinear(
+					valueCorner<P>(hx, hy, 0, 0, seed),
+					valueCorner<P>(hx, hy, 1, 0, seed),
+					valueCorner<P>(hx, hy, 0, 1, seed),
+					valueCorner<P>(hx, hy, 1, 1, seed), fx, fy);
+			}
+			else if constexpr (M == interpolation::quintic) {
+				return biquintic(
+					valueCorner<P>(hx, hy, 0, 0, seed),
+					valueCorner<P>(hx, hy, 1, 0, seed),
+					valueCorner<P>(hx, hy, 0, 1, seed),
+					valueCorner<P>(hx, hy, 1, 1, seed), fx, fy);
+			}
+			else {
+				P rows[4];
+				for (s32 dy = -1; dy <= 2; dy++) {
+					rows[dy + 1] = cubic(
+						valueCorner<P>(hx, hy, -1, dy, seed),
+						valueCorner<P>(hx, hy, 0, dy, seed),
+						valueCorner<P>(hx, hy, 1, dy, seed),
+						valueCorner<P>(hx, hy, 2, dy, seed), fx);
+				};
+				return cubic(rows[0], rows[1], rows[2], rows[3], fy);
+			};
+		};
+
+		// runs kernel(x, y) over count points, padding the last partial pack
+		template<typename P, typename T, typename F> void batch(const T* xs, const T* ys, std::size_t count, T* out, const F& kernel) {
+			constexpr std::size_t W = P::width;
+
+			std::size_t i = 0;
+			for (; i + W <= count; i += W) {
+				kernel(P::load(xs + i), P::load(ys + i)).store(out + i);
+			};
+
+			if (i < count) {
+				T x[W] = {}, y[W] = {}, res[W];
+				for (std::size_t k = 0; k < count - i; k++) {
+					x[k] = xs[i + k];
+					y[k] = ys[i + k];
+				};
+				kernel(P::load(x), P::load(y)).store(res);
+				for (std::size_t k = 0; k < count - i; k++) {
+					out[i + k] = res[k];
+				};
+			};
+		};
+
+		template<interpolation M, typename P, typename T = typename P::scalar> void perlinPoints(const T* xs, const T* ys, std::size_t count, T* out, u32 seed) {
+			batch<P>(xs, ys, count, out, [&](const P& x, const P& y) { return perlinPoint<M>(x, y, seed); });
+		};
+
+		template<interpolation M, typename P, typename T = typename P::scalar> void valuePoints(const T* xs, const T* ys, std::size_t count, T* out, u32 seed) {
+			batch<P>(xs, ys, count, out, [&](const P& x, const P& y) { return valuePoint<M>(x, y, seed); });
+		};
+	};
+};
\ No newline at end of file
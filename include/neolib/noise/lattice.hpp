@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <vector>
+
+#include "..\flat_map.hpp"
+#include "..\random.hpp"
+#include "..\simd.hpp"
+#include "..\vector\vector2.hpp"
+
+namespace nl {
+	// how a noise generator stores the pseudo-random data attached to its lattice points
+	//   cached - computed on first use and kept per coordinate (grows with the visited area)
+	//   hashed - derived from a coordinate hash on every lookup, nothing is stored
+	//   tiled  - computed a whole tile at a time into a tileCache with a fixed memory budget
+	//   periodic - hashed values of the coordinates wrapped to a period, so the output tiles
+	//              seamlessly; small periods are precomputed into a dense periodicTable
+	enum class lattice {
+		cached, hashed, tiled, periodic
+	};
+
+	// the hash behind lattice::hashed and lattice::periodic
+	constexpr u32 latticeHash(const s32vec2& coord, const u32& seed) {
+		return hash2d(seed, u32(coord.x), u32(coord.y));
+	};
+
+	template<std::size_t W> simd::upack<W> latticeHash(const simd::upack<W>& x, const simd::upack<W>& y, const u32& seed) {
+		return hash2d(seed, x, y);
+	};
+
+	// FNV-1a over the bytes of v chained through h; generators fold their parameters into a
+	// fingerprint with it, equal fingerprints meaning equal output (e.g. for persisted tiles)
+	template<typename V> u64 fingerprintOf(const V& v, u64 h = 0xcbf29ce484222325) {
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&v);
+		for (std::size_t i = 0; i < sizeof(V); i++) {
+			h ^= bytes[i];
+			h *= 0x100000001b3;
+		};
+		return h;
+	};
+
+	constexpr u32 gradientCount = 256;
+
+	// unit vectors evenly spread around the circle, indexed by the low byte of latticeHash;
+	// the f32 table is rounded from the f64 one so both precisions pick the same directions
+	template<typename T = f64> const std::array<vector2<T>, gradientCount>& gradientTable() {
+		static const std::array<vector2<T>, gradientCount> table = [] {
+			std::array<vector2<T>, gradientCount> res;
+			for (u32 i = 0; i < gradientCount; i++) {
+				f64vec2 g = f64vec2(angle((f64(i) + 0.5) * angle::tau / f64(gradientCount)));
+				res[i] = vector2<T>(T(g.x), T(g.y));
+			};
+			return res;
+		}();
+		return table;
+	};
+
+	// gradientTable split into component arrays for gathers
+	template<typename T = f64> struct gradientComponents {
+		std::array<T, gradientCount> x, y;
+	};
+
+	template<typename T = f64> const gradientComponents<T>& gradientTableSoA() {
+		static const gradientComponents<T> table = [] {
+			gradientComponents<T> res;
+			for (u32 i = 0; i < gradientCount; i++) {
+				res.x[i] = gradientTable<T>()[i].x;
+				res.y[i] = gradientTable<T>()[i].y;
+			};
+			return res;
+		}();
+		return table;
+	};
+
+	// dense Size x Size blocks of lattice data keyed by tile coordinate; once the byte budget
+	// is reached the least recently referenced tile is recycled (clock / second chance)
+	template<typename T, s32 Size = 64> class tileCache {
+		static_assert(Size > 0 && (Size & (Size - 1)) == 0, "tile size must be a power of two");
+	public:
+		static constexpr s32 size = Size;
+		static constexpr s32 shift = std::countr_zero(u32(Size));
+		static constexpr std::size_t tileBytes = sizeof(T) * Size * Size;
+
+		struct tile {
+			s32vec2 coord;
+			bool referenced = false;
+			std::vector<T> data;
+		};
+
+	private:
+		std::vector<tile> tiles;
+		flat_map<s32vec2, u32> index;
+		std::size_t budget = std::size_t(1) << 24;
+		u32 hand = 0;
+
+		u32 last = 0;
+		bool lastValid = false;
+
+		template<typename F> u32 load(const s32vec2& tcoord, const F& generate) {
+			u32 slot;
+			if (tiles.size() < capacity()) {
+				slot = u32(tiles.size());
+				tiles.emplace_back();
+				tiles[slot].data.resize(std::size_t(Size) * Size);
+			}
+			else {
+				while (tiles[hand].referenced) {
+					tiles[hand].referenced = false;
+					hand = (hand + 1) % u32(tiles.size());
+				};
+				slot = hand;
+				hand = (hand + 1) % u32(tiles.size());
+				index.erase(tiles[slot].coord);
+			};
+
+			tile& t = tiles[slot];
+			t.coord = tcoord;
+			t.referenced = true;
+
+			s32vec2 base(tcoord.x << shift, tcoord.y << shift);
+			for (s32 y = 0; y < Size; y++) {
+				for (s32 x = 0; x < Size; x++) {
+					t.data[std::size_t(y) * Size + x] = generate(s32vec2(base.x + x, base.y + y));
+				};
+			};
+
+			index.emplace(tcoord, slot);
+			return slot;
+		};
+
+	public:
+		tileCache() = default;
+		tileCache(std::size_t bytes) { budget = bytes; };
+
+		std::size_t capacity() const {
+			return std::max(std::size_t(1), budget / tileBytes);
+		};
+
+		std::size_t memory() const {
+			return tiles.size() * tileBytes;
+		};
+
+		void setBudget(std::size_t bytes) {
+			budget = bytes;
+			if (tiles.size() > capacity()) clear();
+		};
+
+		void clear() {
+			tiles.clear();
+			index.clear();
+			hand = 0;
+			lastValid = false;
+		};
+
+		static constexpr s32vec2 tileOf(const s32vec2& coord) {
+			return s32vec2(coord.x >> shift, coord.y >> shift);
+		};
+
+		// row-major Size x Size block for a tile coordinate, generated on a miss
+		template<typename F> const T* getTile(const s32vec2& tcoord, const F& generate) {
+			if (lastValid && tiles[last].coord.x == tcoord.x && tiles[last].coord.y == tcoord.y) {
+				tiles[last].referenced = true;
+				return tiles[last].data.data();
+			};
+
+			auto it = index.find(tcoord);
+			u32 slot;
+			if (it != index.end()) {
+				slot = it->second;
+				tiles[slot].referenced = true;
+			}
+			else {
+				slot = load(tcoord, generate);
+			};
+
+			last = slot;
+			lastValid = true;
+			return tiles[slot].data.data();
+		};
+
+		template<typename F> const T& get(const s32vec2& coord, const F& generate) {
+			const T* data = getTile(tileOf(coord), generate);
+			return data[std::size_t(coord.y & (Size - 1)) * Size + (coord.x & (Size - 1))];
+		};
+	};
+
+	// the lattice of lattice::periodic: coordinates wrap modulo period along both axes, and for periods
+	// up to denseLimit every value is precomputed into a period x period table of at most denseBytes,
+	// small enough to stay resident in L2 during a fill. That is a period of 256 for perlin's u8 gradient
+	// indices, 128 for f32 and 90 for f64 value noise; larger periods generate from the wrapped
+	// coordinate on every lookup. A period of 0 wraps nothing
+	template<typename V> class periodicTable {
+	public:
+		static constexpr std::size_t denseBytes = 64 * 1024;
+		static constexpr u32 denseLimit = [] {
+			u32 p = 1;
+			while (std::size_t(p + 1) * (p + 1) * sizeof(V) <= denseBytes) p++;
+			return p;
+		}();
+
+	private:
+		u32 period = 0;
+		std::vector<V> values;
+
+	public:
+		u32 getPeriod() const { return period; };
+		bool isDense() const { return !values.empty(); };
+
+		s32vec2 wrap(const s32vec2& coord) const {
+			if (period == 0) return coord;
+			if ((period & (period - 1)) == 0) return s32vec2(coord.x & s32(period - 1), coord.y & s32(period - 1));
+
+			s32 x = coord.x % s32(period);
+			s32 y = coord.y % s32(period);
+			return s32vec2(x < 0 ? x + s32(period) : x, y < 0 ? y + s32(period) : y);
+		};
+
+		// generate(c) computes the value of wrapped coordinate c
+		template<typename F> void build(u32 p, const F& generate) {
+			period = p;
+			values.clear();
+			if (p == 0 || p > denseLimit) return;
+
+			values.resize(std::size_t(p) * p);
+			for (u32 y = 0; y < p; y++) {
+				for (u32 x = 0; x < p; x++) {
+					values[std::size_t(y) * p + x] = generate(s32vec2(s32(x), s32(y)));
+				};
+			};
+		};
+
+		template<typename F> V get(const s32vec2& coord, const F& generate) const {
+			s32vec2 w = wrap(coord);
+			return values.empty() ? generate(w) : values[std::size_t(w.y) * period + w.x];
+		};
+	};
+};
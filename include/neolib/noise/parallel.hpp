@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "..\pool.hpp"
+#include "..\vector\vector2.hpp"
+
+namespace nl {
+	// fillGrid over a region split into tileSize x tileSize tiles scheduled on a work-stealing pool;
+	// out has the same row-major width x height layout as a single fillGrid call. The tiles form their own
+	// pool::group, so it may be called from inside another task on the same pool
+	//
+	// N is any generator with a scalar typedef, a const fillGrid and isConcurrent(); generators that write to a cache
+	// during evaluation (lattice::cached, lattice::tiled) are filled serially on the calling thread
+	template<typename N, typename T = typename N::scalar> void fillGridParallel(const N& noise, pool& workers, const vector2<T>& origin, const vector2<T>& step, u32 width, u32 height, T* out, u32 tileSize = 64) {
+		if (!noise.isConcurrent()) {
+			noise.fillGrid(origin, step, width, height, out);
+			return;
+		};
+
+		tileSize = std::max(tileSize, 1u);
+		pool::group tiles;
+		for (u32 ty = 0; ty < height; ty += tileSize) {
+			for (u32 tx = 0; tx < width; tx += tileSize) {
+				workers.submit(tiles, [&noise, &origin, &step, width, height, out, tileSize, tx, ty] {
+					u32 tw = std::min(tileSize, width - tx);
+					u32 th = std::min(tileSize, height - ty);
+
+					std::vector<T> tile(std::size_t(tw) * th);
+					noise.fillGrid(vector2<T>(origin.x + step.x * T(tx), origin.y + step.y * T(ty)), step, tw, th, tile.data());
+
+					for (u32 j = 0; j < th; j++) {
+						std::copy_n(tile.data() + std::size_t(j) * tw, tw, out + std::size_t(ty + j) * width + tx);
+					};
+				});
+			};
+		};
+
+		workers.wait(tiles);
+	};
+};
\ No newline at end of file
@@ -0,0 +1,327 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "..\flat_map.hpp"
+#include "..\vector\vector2.hpp"
+#include "lattice.hpp"
+
+namespace nl {
+	// a file mapped read/write piece by piece: map() adds a view of a byte range, growing the file to
+	// cover it, and every view stays where it is until close(), so pointers into them never move
+	class mappedFile {
+#if defined(_WIN32)
+		HANDLE file = INVALID_HANDLE_VALUE;
+#else
+		int fd = -1;
+#endif
+		struct view {
+			void* base;
+			std::size_t bytes;
+		};
+		std::vector<view> views;
+		std::size_t bytes = 0;
+
+		// views start at multiples of this
+		static std::size_t granularity() {
+			static const std::size_t res = [] {
+#if defined(_WIN32)
+				SYSTEM_INFO info;
+				GetSystemInfo(&info);
+				return std::size_t(info.dwAllocationGranularity);
+#else
+				return std::size_t(sysconf(_SC_PAGESIZE));
+#endif
+			}();
+			return res;
+		};
+
+		void unmap() {
+			for (const view& v : views) {
+#if defined(_WIN32)
+				UnmapViewOfFile(v.base);
+#else
+				munmap(v.base, v.bytes);
+#endif
+			};
+			views.clear();
+		};
+
+	public:
+		mappedFile() = default;
+		mappedFile(const mappedFile&) = delete;
+		mappedFile& operator=(const mappedFile&) = delete;
+		~mappedFile() { close(); };
+
+		// opens or creates path; nothing is mapped yet
+		bool open(const std::string& path) {
+			close();
+#if defined(_WIN32)
+			file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (file == INVALID_HANDLE_VALUE) return false;
+
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(file, &size)) {
+				close();
+				return false;
+			};
+			bytes = std::size_t(size.QuadPart);
+#else
+			fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+			if (fd < 0) return false;
+
+			struct stat info;
+			if (fstat(fd, &info) != 0) {
+				close();
+				return false;
+			};
+			bytes = std::size_t(info.st_size);
+#endif
+			return true;
+		};
+
+		// unmaps every view and closes the file, cutting it down to keep bytes
+		void close(std::size_t keep) {
+			if (!isOpen()) return;
+			unmap();
+#if defined(_WIN32)
+			LARGE_INTEGER end;
+			end.QuadPart = LONGLONG(keep);
+			if (SetFilePointerEx(file, end, NULL, FILE_BEGIN)) SetEndOfFile(file);
+			CloseHandle(file);
+			file = INVALID_HANDLE_VALUE;
+#else
+			ftruncate(fd, off_t(keep));
+			::close(fd);
+			fd = -1;
+#endif
+			bytes = 0;
+		};
+		void close() {
+			close(bytes);
+		};
+
+		bool isOpen() const {
+#if defined(_WIN32)
+			return file != INVALID_HANDLE_VALUE;
+#else
+			return fd >= 0;
+#endif
+		};
+
+		// bytes offset .. offset + length - 1, growing the file first if it is shorter; null on failure
+		unsigned char* map(std::size_t offset, std::size_t length) {
+			if (!isOpen() || length == 0) return nullptr;
+
+			std::size_t start = offset - offset % granularity();
+			std::size_t span = offset + length - start;
+			std::size_t end = std::max(bytes, offset + length);
+
+#if defined(_WIN32)
+			// a mapping larger than the file extends it; views keep their mapping alive after the handle is closed
+			HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READWRITE, DWORD(u64(end) >> 32), DWORD(end), NULL);
+			if (!mapping) return nullptr;
+			void* p = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, DWORD(u64(start) >> 32), DWORD(start), span);
+			CloseHandle(mapping);
+			if (!p) return nullptr;
+#else
+			if (end > bytes && ftruncate(fd, off_t(end)) != 0) return nullptr;
+			void* p = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_SHARED, fd, off_t(start));
+			if (p == MAP_FAILED) return nullptr;
+#endif
+			bytes = end;
+			views.push_back({ p, span });
+			return static_cast<unsigned char*>(p) + (offset - start);
+		};
+
+		// writes dirty pages back without waiting for the disk
+		void flush() {
+			for (const view& v : views) {
+#if defined(_WIN32)
+				FlushViewOfFile(v.base, 0);
+#else
+				msync(v.base, v.bytes, MS_ASYNC);
+#endif
+			};
+		};
+
+		std::size_t size() const { return bytes; };
+	};
+
+	// Size x Size tiles of noise.fillGrid on the sample grid origin + step * (x, y), persisted in a
+	// memory-mapped file: tiles generated by an earlier run are served straight from the mapping
+	// without being copied or recomputed, missing tiles are generated into it and appended
+	//
+	// file layout, native endianness, version 2 (version 1 files hold lattice::hashed and periodic
+	// tiles from the hash before hash2d and are rebuilt):
+	//   header  - magic "NLTS", version, tile size, scalar size, fingerprint, record count
+	//   records - s32 tile x, s32 tile y, Size * Size row-major scalars
+	// the fingerprint covers the generator's parameters and the sample grid; a file written with
+	// different ones is discarded and rebuilt, and a record only counts once its payload is complete
+	//
+	// records are mapped in chunks of 16, 32, 64, ... that are never remapped, so a pointer from
+	// getTile into the file stays valid for the lifetime of the store. If the file cannot be opened
+	// or grown, tiles are generated into a scratch buffer instead, and such a pointer only stays valid
+	// until the next tile that misses the file. Not thread-safe
+	template<typename N, s32 Size = 64> class tileStore {
+		static_assert(Size > 0 && (Size & (Size - 1)) == 0, "tile size must be a power of two");
+	public:
+		using scalar = typename N::scalar;
+		using vec2 = vector2<scalar>;
+
+		static constexpr u32 magic = 0x53544c4e;
+		static constexpr u32 version = 2;
+		static constexpr s32 size = Size;
+		static constexpr s32 shift = std::countr_zero(u32(Size));
+
+		struct header {
+			u32 magic;
+			u32 version;
+			u32 tileSize;
+			u32 scalarSize;
+			u64 fingerprint;
+			u64 count;
+		};
+		struct record {
+			s32 x;
+			s32 y;
+		};
+		static constexpr std::size_t recordBytes = sizeof(record) + sizeof(scalar) * Size * Size;
+		static constexpr u64 firstChunk = 16;
+
+	private:
+		const N* noise;
+		vec2 origin;
+		vec2 step;
+		u64 print;
+
+		mappedFile file;
+		header* head = nullptr;
+		// chunk c holds records firstChunk * (2^c - 1) .. firstChunk * (2^(c + 1) - 1) - 1
+		std::vector<unsigned char*> chunks;
+		flat_map<s32vec2, const scalar*> index;
+		std::vector<scalar> scratch;
+
+		static u32 chunkOf(u64 i) { return u32(std::bit_width(i / firstChunk + 1) - 1); };
+		static u64 chunkStart(u32 c) { return firstChunk * ((u64(1) << c) - 1); };
+
+		// maps chunks until record i is covered
+		bool reserve(u64 i) {
+			while (chunks.size() <= chunkOf(i)) {
+				u32 c = u32(chunks.size());
+				unsigned char* p = file.map(sizeof(header) + chunkStart(c) * recordBytes, (firstChunk << c) * recordBytes);
+				if (!p) return false;
+				chunks.push_back(p);
+			};
+			return true;
+		};
+
+		record& recordAt(u64 i) const {
+			u32 c = chunkOf(i);
+			return *reinterpret_cast<record*>(chunks[c] + (i - chunkStart(c)) * recordBytes);
+		};
+		scalar* payload(u64 i) const { return reinterpret_cast<scalar*>(&recordAt(i) + 1); };
+
+		bool reset() {
+			index.clear();
+			*head = header{ magic, version, u32(Size), u32(sizeof(scalar)), print, 0 };
+			return true;
+		};
+
+		bool load() {
+			bool fresh = file.size() < sizeof(header);
+			head = reinterpret_cast<header*>(file.map(0, sizeof(header)));
+			if (!head) return false;
+			if (fresh) return reset();
+
+			const header& h = *head;
+			if (h.magic != magic || h.version != version || h.tileSize != u32(Size) || h.scalarSize != sizeof(scalar) ||
+				h.fingerprint != print || h.count > (file.size() - sizeof(header)) / recordBytes) {
+				return reset();
+			};
+
+			if (h.count > 0 && !reserve(h.count - 1)) return false;
+			for (u64 i = 0; i < h.count; i++) {
+				index.emplace(s32vec2(recordAt(i).x, recordAt(i).y), payload(i));
+			};
+			return true;
+		};
+
+		void generate(const s32vec2& tcoord, scalar* dst) const {
+			vec2 corner(origin.x + step.x * scalar(s64(tcoord.x) << shift), origin.y + step.y * scalar(s64(tcoord.y) << shift));
+			noise->fillGrid(corner, step, u32(Size), u32(Size), dst);
+		};
+
+		const scalar* generateScratch(const s32vec2& tcoord) {
+			scratch.resize(std::size_t(Size) * Size);
+			generate(tcoord, scratch.data());
+			return scratch.data();
+		};
+
+	public:
+		tileStore(const N& n, const std::string& path, const vec2& org, const vec2& stp) {
+			noise = &n;
+			origin = org;
+			step = stp;
+			print = fingerprintOf(step, fingerprintOf(origin, n.fingerprint()));
+
+			if (file.open(path) && !load()) {
+				file.close();
+				chunks.clear();
+				index.clear();
+			};
+		};
+		~tileStore() {
+			if (isOpen()) file.close(sizeof(header) + head->count * recordBytes);
+		};
+
+		bool isOpen() const { return file.isOpen(); };
+
+		// tiles held in the file
+		std::size_t tiles() const { return index.size(); };
+
+		// the tile covering samples tcoord * Size .. tcoord * Size + Size - 1 in both axes
+		const scalar* getTile(const s32vec2& tcoord) {
+			auto it = index.find(tcoord);
+			if (it != index.end()) return it->second;
+
+			// tiles already served stay mapped, so a file that cannot grow only stops taking new ones
+			u64 n = isOpen() ? head->count : 0;
+			if (!isOpen() || !reserve(n)) return generateScratch(tcoord);
+
+			recordAt(n) = record{ tcoord.x, tcoord.y };
+			generate(tcoord, payload(n));
+			head->count = n + 1;
+
+			index.emplace(tcoord, payload(n));
+			return payload(n);
+		};
+
+		scalar get(const s32vec2& sample) {
+			const scalar* tile = getTile(s32vec2(sample.x >> shift, sample.y >> shift));
+			return tile[std::size_t(sample.y & (Size - 1)) * Size + (sample.x & (Size - 1))];
+		};
+
+		void flush() {
+			file.flush();
+		};
+	};
+};
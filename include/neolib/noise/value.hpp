@@ -1,79 +1,268 @@
 #pragma once
 
-#include <unordered_map>
+#include <vector>
 
-#include "vector/vector2.hpp"
-#include "interpolation.hpp"
-#include "random.hpp"
+#include "..\flat_map.hpp"
+#include "..\vector\vector2.hpp"
+#include "..\interpolation.hpp"
+#include "..\random.hpp"
+#include "lattice.hpp"
+#include "kernels.hpp"
 
 namespace nl {
-	class baseNoise2d {
+	// same threading rules as perlin::base2d: only lattice::hashed and lattice::periodic evaluation is free of writes
+	template<typename T> class baseNoise2dT {
 	public:
-		std::unordered_map<nl::s32vec2, f64> map;
+		using scalar = T;
+		using vec2 = vector2<T>;
+
+		mutable flat_map<nl::s32vec2, T> map;
+		mutable tileCache<T> tiles;
+		periodicTable<T> periodic;
 		u64 seed = 1;
 		interpolation mode = interpolation::linear;
+		lattice storage = lattice::cached;
+
+		baseNoise2dT() = default;
+		baseNoise2dT(const u64& s) { seed = s; };
+		baseNoise2dT(const u64& s, const interpolation& ip) { seed = s; mode = ip; };
+		baseNoise2dT(const u64& s, const interpolation& ip, const lattice& st) { seed = s; mode = ip; storage = st; };
+
+		bool isConcurrent() const {
+			return storage == lattice::hashed || storage == lattice::periodic;
+		};
+
+		// see perlin::base2d::setPeriod
+		void setPeriod(u32 p) {
+			storage = lattice::periodic;
+			periodic.build(p, [this](const s32vec2& c) { return hashedLatticePoint(c); });
+		};
+
+		u64 fingerprint() const {
+			u64 h = fingerprintOf(u32(sizeof(T)));
+			h = fingerprintOf(seed, h);
+			h = fingerprintOf(mode, h);
+			h = fingerprintOf(storage == lattice::hashed, h);
+			return storage == lattice::periodic ? fingerprintOf(periodic.getPeriod(), h) : h;
+		};
+
+		T hashedLatticePoint(const s32vec2& coord) const {
+			return T(latticeHash(coord, u32(seed))) / T(4294967296.0);
+		};
+
+		T generateLatticePoint(const s32vec2& coord) const {
+			u32 x = coord.x;
+			u32 y = coord.y;
+			return T(random_clamped_uf64(random_u32(x ^ quarter_u32(y)) * seed));
+		};
+
+		T getLatticePoint(const s32vec2& coord) const {
+			switch (storage) {
+			case(lattice::hashed):
+				return hashedLatticePoint(coord);
+				break;
+			case(lattice::periodic):
+				return periodic.get(coord, [this](const s32vec2& c) { return hashedLatticePoint(c); });
+				break;
+			case(lattice::tiled):
+				return tiles.get(coord, [this](const s32vec2& c) { return generateLatticePoint(c); });
+				break;
+			default:
+				auto it = map.find(coord);
+				if (it != map.end()) {
+					return it->second;
+				}
+				else {
+					T val = generateLatticePoint(coord);
+					map.emplace(coord, val);
+					return val;
+				};
+				break;
+			};
+		};
+
+		// lattice values mode M needs around a cell, stencil[(dy + 1) * 4 + (dx + 1)] for dx, dy in [-1, 2]
+		template<interpolation M> void getLatticeStencil(const s32vec2& icoord, T* stencil) const {
+			if constexpr (M == interpolation::nearest) {
+				stencil[5] = getLatticePoint(icoord);
+			}
+			else if constexpr (M == interpolation::linear || M == interpolation::quintic) {
+				stencil[5] = getLatticePoint({ icoord.x, icoord.y });
+				stencil[6] = getLatticePoint({ icoord.x + 1, icoord.y });
+				stencil[9] = getLatticePoint({ icoord.x, icoord.y + 1 });
+				stencil[10] = getLatticePoint({ icoord.x + 1, icoord.y + 1 });
+			}
+			else {
+				for (s32 dy = -1; dy <= 2; dy++) {
+					for (s32 dx = -1; dx <= 2; dx++) {
+						stencil[(dy + 1) * 4 + (dx + 1)] = getLatticePoint({ icoord.x + dx, icoord.y + dy });
+					};
+				};
+			};
+		};
 
-		baseNoise2d() = default;
-		baseNoise2d(const u64& s) { seed = s; };
-		baseNoise2d(const u64& s, const interpolation& ip) { seed = s; mode = ip; };
+		template<interpolation M> T getStencilPoint(const T* stencil, const vec2& coord) const {
+			vec2 fcoord(fraction(coord.x), fraction(coord.y));
 
-		f64 getLatticePoint(const s32vec2& coord) {
-			if (map.contains(coord)) {
-				return map[coord];
+			if constexpr (M == interpolation::nearest) {
+				return stencil[5];
+			}
+			else if constexpr (M == interpolation::linear) {
+				return bilinearInterpolation(stencil[5], stencil[6], stencil[9], stencil[10], fcoord);
+			}
+			else if constexpr (M == interpolation::quintic) {
+				return biquinticInterpolation(stencil[5], stencil[6], stencil[9], stencil[10], fcoord);
 			}
 			else {
-				u32 x = coord.x;
-				u32 y = coord.y;
-				f64 val = random_clamped_uf64(random_u32(x ^ quarter_u32(y)) * seed);
-				map[coord] = val;
-				return val;
+				return bicubicInterpolation(
+					stencil[0], stencil[1], stencil[2], stencil[3],
+					stencil[4], stencil[5], stencil[6], stencil[7],
+					stencil[8], stencil[9], stencil[10], stencil[11],
+					stencil[12], stencil[13], stencil[14], stencil[15], fcoord);
 			};
 		};
 
-		f64 getPoint(const f64vec2& coord) {
-			f64vec2 fcoord(fraction(coord.x), fraction(coord.y));
+		template<interpolation M> T getPoint(const vec2& coord) const {
 			s32vec2 icoord(std::floor(coord.x), std::floor(coord.y));
 
-			f64 laa = getLatticePoint({ icoord.x, icoord.y });
-			f64 lba = getLatticePoint({ icoord.x + 1, icoord.y });
-			f64 lab = getLatticePoint({ icoord.x, icoord.y + 1 });
-			f64 lbb = getLatticePoint({ icoord.x + 1, icoord.y + 1 });
-
-			f64 aa = getLatticePoint({ icoord.x - 1, icoord.y - 1 });
-			f64 ba = getLatticePoint({ icoord.x, icoord.y - 1 });
-			f64 ca = getLatticePoint({ icoord.x + 1, icoord.y - 1 });
-			f64 da = getLatticePoint({ icoord.x + 2, icoord.y - 1 });
-
-			f64 ab = getLatticePoint({ icoord.x - 1, icoord.y });
-			f64 bb = getLatticePoint({ icoord.x, icoord.y });
-			f64 cb = getLatticePoint({ icoord.x + 1, icoord.y });
-			f64 db = getLatticePoint({ icoord.x + 2, icoord.y });
-
-			f64 ac = getLatticePoint({ icoord.x - 1, icoord.y + 1 });
-			f64 bc = getLatticePoint({ icoord.x, icoord.y + 1 });
-			f64 cc = getLatticePoint({ icoord.x + 1, icoord.y + 1 });
-			f64 dc = getLatticePoint({ icoord.x + 2, icoord.y + 1 });
-
-			f64 ad = getLatticePoint({ icoord.x - 1, icoord.y + 2 });
-			f64 bd = getLatticePoint({ icoord.x, icoord.y + 2 });
-			f64 cd = getLatticePoint({ icoord.x + 1, icoord.y + 2 });
-			f64 dd = getLatticePoint({ icoord.x + 2, icoord.y + 2 });
-
-			switch (mode) {
-			case(interpolation::discrete):
-				return getLatticePoint(icoord);
-				break;
-			case(interpolation::linear):
-				return bilinearInterpolation(laa, lba, lab, lbb, fcoord);
-				break;
-			case(interpolation::cubic):
+			T stencil[16];
+			getLatticeStencil<M>(icoord, stencil);
+			return getStencilPoint<M>(stencil, coord);
+		};
+
+		// getPoint<M> and its partial derivatives; the lattice values are constants, so the gradient
+		// only comes from the interpolation weights
+		template<interpolation M> gradientPoint<T> getPointWithGradient(const vec2& coord) const {
+			using G = gradientPoint<T>;
+			s32vec2 icoord(std::floor(coord.x), std::floor(coord.y));
+
+			T stencil[16];
+			getLatticeStencil<M>(icoord, stencil);
+
+			auto s = [&](u32 i) { return G(stencil[i]); };
+			vector2<G> fcoord(G(fraction(coord.x), T(1), T(0)), G(fraction(coord.y), T(0), T(1)));
+
+			if constexpr (M == interpolation::nearest) {
+				return G(stencil[5]);
+			}
+			else if constexpr (M == interpolation::linear) {
+				return bilinearInterpolation(s(5), s(6), s(9), s(10), fcoord);
+			}
+			else if constexpr (M == interpolation::quintic) {
+				return biquinticInterpolation(s(5), s(6), s(9), s(10), fcoord);
+			}
+			else {
 				return bicubicInterpolation(
-					aa, ba, ca, da,
-					ab, bb, cb, db,
-					ac, bc, cc, dc,
-					ad, bd, cd, dd, fcoord);
-				break;
+					s(0), s(1), s(2), s(3),
+					s(4), s(5), s(6), s(7),
+					s(8), s(9), s(10), s(11),
+					s(12), s(13), s(14), s(15), fcoord);
+			};
+		};
+
+		template<interpolation M> void getPoints(const T* xs, const T* ys, std::size_t count, T* out) const {
+			if (storage == lattice::hashed) {
+				kernels::valuePoints<M, simd::packOf<T>>(xs, ys, count, out, u32(seed));
+			}
+			else {
+				for (std::size_t i = 0; i < count; i++) {
+					out[i] = getPoint<M>(vec2(xs[i], ys[i]));
+				};
+			};
+		};
+
+		template<interpolation M> void fillGrid(const vec2& origin, const vec2& step, u32 width, u32 height, T* out) const {
+			if (storage == lattice::hashed) {
+				std::vector<T> xs(width), ys(width);
+				for (u32 i = 0; i < width; i++) {
+					xs[i] = origin.x + step.x * T(i);
+				};
+				for (u32 j = 0; j < height; j++) {
+					std::fill(ys.begin(), ys.end(), origin.y + step.y * T(j));
+					getPoints<M>(xs.data(), ys.data(), width, out + std::size_t(j) * width);
+				};
+				return;
+			};
+
+			T stencil[16];
+
+			for (u32 j = 0; j < height; j++) {
+				T y = origin.y + step.y * T(j);
+				s32vec2 cell;
+				bool valid = false;
+
+				for (u32 i = 0; i < width; i++) {
+					vec2 coord(origin.x + step.x * T(i), y);
+					s32vec2 icoord(std::floor(coord.x), std::floor(coord.y));
+
+					if (!valid || icoord.x != cell.x || icoord.y != cell.y) {
+						getLatticeStencil<M>(icoord, stencil);
+						cell = icoord;
+						valid = true;
+					};
+
+					out[std::size_t(j) * width + i] = getStencilPoint<M>(stencil, coord);
+				};
 			};
 		};
+
+		void getLatticeStencil(const s32vec2& icoord, T* stencil) const {
+			withInterpolation(mode, [&](auto m) { getLatticeStencil<decltype(m)::value>(icoord, stencil); });
+		};
+
+		T getStencilPoint(const T* stencil, const vec2& coord) const {
+			return withInterpolation(mode, [&](auto m) { return getStencilPoint<decltype(m)::value>(stencil, coord); });
+		};
+
+		T getPoint(const vec2& coord) const {
+			return withInterpolation(mode, [&](auto m) { return getPoint<decltype(m)::value>(coord); });
+		};
+
+		gradientPoint<T> getPointWithGradient(const vec2& coord) const {
+			return withInterpolation(mode, [&](auto m) { return getPointWithGradient<decltype(m)::value>(coord); });
+		};
+
+		// out[i] = getPoint({ xs[i], ys[i] }); lattice::hashed runs the simd::packOf<T> kernel, the other
+		// storage modes fall back to one scalar getPoint per sample
+		void getPoints(const T* xs, const T* ys, std::size_t count, T* out) const {
+			withInterpolation(mode, [&](auto m) { getPoints<decltype(m)::value>(xs, ys, count, out); });
+		};
+
+		// samples origin + step * (i, j) into out[j * width + i]; the lattice stencil is only
+		// refetched when a row crosses into a new cell
+		void fillGrid(const vec2& origin, const vec2& step, u32 width, u32 height, T* out) const {
+			withInterpolation(mode, [&](auto m) { fillGrid<decltype(m)::value>(origin, step, width, height, out); });
+		};
+	};
+
+	// baseNoise2d with the interpolation mode fixed at compile time
+	template<interpolation Mode, typename T = f64> class fixedNoise2d : public baseNoise2dT<T> {
+	public:
+		using vec2 = vector2<T>;
+
+		fixedNoise2d() { this->mode = Mode; };
+		fixedNoise2d(const u64& s) : baseNoise2dT<T>(s, Mode) {};
+		fixedNoise2d(const u64& s, const lattice& st) : baseNoise2dT<T>(s, Mode, st) {};
+
+		T getPoint(const vec2& coord) const {
+			return baseNoise2dT<T>::template getPoint<Mode>(coord);
+		};
+
+		gradientPoint<T> getPointWithGradient(const vec2& coord) const {
+			return baseNoise2dT<T>::template getPointWithGradient<Mode>(coord);
+		};
+
+		void getPoints(const T* xs, const T* ys, std::size_t count, T* out) const {
+			baseNoise2dT<T>::template getPoints<Mode>(xs, ys, count, out);
+		};
+
+		void fillGrid(const vec2& origin, const vec2& step, u32 width, u32 height, T* out) const {
+			baseNoise2dT<T>::template fillGrid<Mode>(origin, step, width, height, out);
+		};
 	};
+
+	// the f32 instantiation stays within 1e-6 of the f64 reference at f32-representable coordinates
+	using baseNoise2d = baseNoise2dT<f64>;
+	using f32baseNoise2d = baseNoise2dT<f32>;
+	using f64baseNoise2d = baseNoise2dT<f64>;
 };
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "..\vector\vector2.hpp"
+#include "perlin.hpp"
+
+namespace nl {
+	// width x height samples of a generator kept resident around a movable window position
+	//
+	// window sample (x, y) is the generator at origin + step * (position + (x, y)); the buffer is a
+	// ring in both axes, so a move only runs fillGrid over the rows and columns that came into view
+	// and every other sample stays where it is; results match one fillGrid over the whole window up
+	// to the rounding of the strip origins
+	template<typename N = perlin::additive2d> class window2d {
+	public:
+		using scalar = typename N::scalar;
+		using vec2 = vector2<scalar>;
+
+	private:
+		const N* noise;
+		vec2 origin;
+		vec2 step;
+		u32 width;
+		u32 height;
+
+		s32vec2 pos;
+		std::vector<scalar> data;
+		std::vector<scalar> strip;
+		std::size_t count = 0;
+
+		static u32 wrap(s64 v, u32 n) {
+			s64 r = v % s64(n);
+			return u32(r < 0 ? r + n : r);
+		};
+
+		// evaluates the w x h block of samples starting at absolute sample index start into the ring
+		void fill(s64 x, s64 y, u32 w, u32 h) {
+			if (w == 0 || h == 0) return;
+
+			strip.resize(std::size_t(w) * h);
+			noise->fillGrid(vec2(origin.x + step.x * scalar(x), origin.y + step.y * scalar(y)), step, w, h, strip.data());
+			count += strip.size();
+
+			u32 x0 = wrap(x, width);
+			u32 split = std::min(w, width - x0);
+			for (u32 j = 0; j < h; j++) {
+				scalar* row = data.data() + std::size_t(wrap(y + j, height)) * width;
+				const scalar* src = strip.data() + std::size_t(j) * w;
+
+				std::copy_n(src, split, row + x0);
+				std::copy_n(src + split, w - split, row);
+			};
+		};
+
+	public:
+		window2d(const N& n, const vec2& org, const vec2& stp, u32 w, u32 h, const s32vec2& position = s32vec2()) {
+			noise = &n;
+			origin = org;
+			step = stp;
+			width = std::max(w, 1u);
+			height = std::max(h, 1u);
+
+			pos = position;
+			data.resize(std::size_t(width) * height);
+			refresh();
+		};
+
+		u32 getWidth() const { return width; };
+		u32 getHeight() const { return height; };
+		const s32vec2& position() const { return pos; };
+
+		// total samples evaluated so far, for checking that per-frame cost follows the movement
+		std::size_t evaluated() const { return count; };
+
+		// re-evaluates the whole window, e.g. after the generator's parameters changed
+		void refresh() {
+			fill(pos.x, pos.y, width, height);
+		};
+
+		void moveTo(const s32vec2& target) {
+			s64 dx = s64(target.x) - pos.x;
+			s64 dy = s64(target.y) - pos.y;
+			pos = target;
+
+			if (std::abs(dx) >= width || std::abs(dy) >= height) {
+				refresh();
+				return;
+			};
+
+			u32 adx = u32(std::abs(dx));
+			u32 ady = u32(std::abs(dy));
+
+			// rows that came into view span the full width, the columns only the rows that were kept
+			s64 rows = dy > 0 ? s64(pos.y) + height - ady : s64(pos.y);
+			s64 kept = dy > 0 ? s64(pos.y) : s64(pos.y) + ady;
+			s64 cols = dx > 0 ? s64(pos.x) + width - adx : s64(pos.x);
+
+			fill(pos.x, rows, width, ady);
+			fill(cols, kept, adx, height - ady);
+		};
+
+		void moveBy(const s32vec2& delta) {
+			moveTo(s32vec2(pos.x + delta.x, pos.y + delta.y));
+		};
+
+		// moves the window so that the world coordinate coord falls in its centre sample
+		void centreOn(const vec2& coord) {
+			s32vec2 target(std::floor((coord.x - origin.x) / step.x), std::floor((coord.y - origin.y) / step.y));
+			moveTo(s32vec2(target.x - s32(width / 2), target.y - s32(height / 2)));
+		};
+
+		scalar at(u32 x, u32 y) const {
+			return data[std::size_t(wrap(s64(pos.y) + y, height)) * width + wrap(s64(pos.x) + x, width)];
+		};
+
+		// unrolls the ring into a row-major width x height buffer
+		void copyTo(scalar* out) const {
+			u32 x0 = wrap(pos.x, width);
+			for (u32 j = 0; j < height; j++) {
+				const scalar* row = data.data() + std::size_t(wrap(s64(pos.y) + j, height)) * width;
+				scalar* dst = out + std::size_t(j) * width;
+
+				dst = std::copy(row + x0, row + width, dst);
+				std::copy(row, row + x0, dst);
+			};
+		};
+	};
+};
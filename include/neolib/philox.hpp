@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <span>
+
+#include "simd.hpp"
+
+namespace nl {
+	// Philox4x32-10 (Salmon et al., Random123): a keyed bijection of a 128 bit counter, so value n of
+	// a stream depends only on the key and n, never on what was drawn before; workers can produce
+	// any slice of the stream in any order and get the same numbers as a single thread
+	//
+	// the counter is the block index in the low 64 bits and the stream in the high 64, giving each
+	// key 2^64 independent streams of 2^64 blocks of 4 x u32; words are numbered 4 * block + lane
+	class philox {
+	public:
+		using block = std::array<u32, 4>;
+
+		static constexpr u32 multiplier0 = 0xd2511f53;
+		static constexpr u32 multiplier1 = 0xcd9e8d57;
+		static constexpr u32 weyl0 = 0x9e3779b9;
+		static constexpr u32 weyl1 = 0xbb67ae85;
+		static constexpr u32 rounds = 10;
+
+	private:
+		u64 key;
+		u64 stream;
+
+		template<std::size_t W> struct lanes {
+			simd::upack<W> c[4];
+		};
+
+		// the 10 rounds on W counters at once; identical to the scalar block for W = 1
+		template<std::size_t W> static void encrypt(lanes<W>& s, u32 k0, u32 k1) {
+			using U = simd::upack<W>;
+			const U m0 = U::broadcast(multiplier0);
+			const U m1 = U::broadcast(multiplier1);
+
+			for (u32 r = 0; r < rounds; r++) {
+				U hi0 = mulhi(m0, s.c[0]);
+				U lo0 = m0 * s.c[0];
+				U hi1 = mulhi(m1, s.c[2]);
+				U lo1 = m1 * s.c[2];
+
+				s.c[0] = hi1 ^ s.c[1] ^ U::broadcast(k0);
+				s.c[1] = lo1;
+				s.c[2] = hi0 ^ s.c[3] ^ U::broadcast(k1);
+				s.c[3] = lo0;
+
+				k0 += weyl0;
+				k1 += weyl1;
+			};
+		};
+
+	public:
+		constexpr philox(u64 k = 0, u64 s = 0) {
+			key = k;
+			stream = s;
+		};
+
+		constexpr u64 getKey() const { return key; };
+		constexpr u64 getStream() const { return stream; };
+
+		// the block at a full 128 bit counter
+		static constexpr block generateBlock(u64 key, u64 counterLow, u64 counterHigh) {
+			u32 c[4] = { u32(counterLow), u32(counterLow >> 32), u32(counterHigh), u32(counterHigh >> 32) };
+			u32 k0 = u32(key);
+			u32 k1 = u32(key >> 32);
+
+			for (u32 r = 0; r < rounds; r++) {
+				u64 p0 = u64(multiplier0) * c[0];
+				u64 p1 = u64(multiplier1) * c[2];
+
+				c[0] = u32(p1 >> 32) ^ c[1] ^ k0;
+				c[1] = u32(p1);
+				c[2] = u32(p0 >> 32) ^ c[3] ^ k1;
+				c[3] = u32(p0);
+
+				k0 += weyl0;
+				k1 += weyl1;
+			};
+			return { c[0], c[1], c[2], c[3] };
+		};
+
+		constexpr block operator()(u64 index) const {
+			return generateBlock(key, index, stream);
+		};
+
+		constexpr u32 word(u64 index) const {
+			return (*this)(index / 4)[index % 4];
+		};
+
+		// words 2 * index and 2 * index + 1, the first in the low half
+		constexpr u64 value(u64 index) const {
+			block b = (*this)(index / 2);
+			return index % 2 == 0 ? b[0] | (u64(b[1]) << 32) : b[2] | (u64(b[3]) << 32);
+		};
+
+		// out[i] = word(first + i); whole blocks are generated simd::f32width at a time
+		void generate(u64 first, std::span<u32> out) const {
+			constexpr std::size_t W = simd::f32width;
+			using U = simd::upack<W>;
+
+			std::size_t i = 0;
+			for (; i < out.size() && (first + i) % 4 != 0; i++) {
+				out[i] = word(first + i);
+			};
+
+			u32 offsets[W];
+			for (u32 l = 0; l < W; l++) offsets[l] = l;
+			const U laneOffsets = U::load(offsets);
+
+			for (; i + 4 * W <= out.size(); i += 4 * W) {
+				u64 index = (first + i) / 4;
+
+				// the low counter word wraps inside this batch; rare enough to leave to the scalar blocks
+				if (u32(index) > u32(index + W - 1)) {
+					for (u32 l = 0; l < W; l++) {
+						block b = (*this)(index + l);
+						for (u32 j = 0; j < 4; j++) out[i + 4 * l + j] = b[j];
+					};
+					continue;
+				};
+
+				lanes<W> s;
+				s.c[0] = U::broadcast(u32(index)) + laneOffsets;
+				s.c[1] = U::broadcast(u32(index >> 32));
+				s.c[2] = U::broadcast(u32(stream));
+				s.c[3] = U::broadcast(u32(stream >> 32));
+				encrypt(s, u32(key), u32(key >> 32));
+
+				u32 words[4][W];
+				for (u32 j = 0; j < 4; j++) s.c[j].store(words[j]);
+				for (u32 l = 0; l < W; l++) {
+					for (u32 j = 0; j < 4; j++) out[i + 4 * l + j] = words[j][l];
+				};
+			};
+
+			for (; i < out.size(); i++) {
+				out[i] = word(first + i);
+			};
+		};
+
+		// out[i] = value(first + i); the words go through a local buffer, a batch of blocks at a time
+		void generate(u64 first, std::span<u64> out) const {
+			constexpr std::size_t batch = 64;
+			u32 words[2 * batch];
+
+			for (std::size_t i = 0; i < out.size(); i += batch) {
+				std::size_t n = std::min(batch, out.size() - i);
+				generate(2 * (first + i), std::span<u32>(words, 2 * n));
+				for (std::size_t j = 0; j < n; j++) {
+					out[i + j] = words[2 * j] | (u64(words[2 * j + 1]) << 32);
+				};
+			};
+		};
+	};
+};
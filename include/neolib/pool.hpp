@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "base.hpp"
+
+namespace nl {
+	// work-stealing thread pool: every worker owns a deque, runs its own tasks newest first and
+	// steals the oldest task of another worker once it runs dry
+	//
+	// tasks are submitted into a group and wait(group) returns once that group's tasks have finished,
+	// so a task may submit a group of its own and wait on it: the waiting thread runs queued tasks
+	// meanwhile instead of blocking a worker. submit(task) and wait() use a group shared by all callers
+	// and must not be called from inside a task
+	//
+	// a task that throws still counts as finished; the first exception of a group is kept and rethrown
+	// by the next wait on it, later ones are dropped
+	class pool {
+	public:
+		class group {
+			friend class pool;
+
+			std::atomic<std::size_t> pending = 0;
+			std::mutex errorLock;
+			std::exception_ptr error;
+
+		public:
+			group() = default;
+			group(const group&) = delete;
+			group& operator=(const group&) = delete;
+		};
+
+	private:
+		struct job {
+			std::function<void()> task;
+			group* from = nullptr;
+		};
+
+		struct queue {
+			std::mutex lock;
+			std::deque<job> tasks;
+		};
+
+		std::vector<std::unique_ptr<queue>> queues;
+		std::vector<std::thread> workers;
+
+		std::atomic<bool> stop = false;
+		std::atomic<std::size_t> pending = 0;
+		std::atomic<std::size_t> queued = 0;
+		std::atomic<u32> next = 0;
+
+		std::mutex sleepLock;
+		std::condition_variable wake;
+		std::condition_variable done;
+
+		group shared;
+
+		static inline thread_local const pool* owner = nullptr;
+		static inline thread_local u32 self = 0;
+
+		bool pop(u32 q, job& task) {
+			std::lock_guard<std::mutex> guard(queues[q]->lock);
+			if (queues[q]->tasks.empty()) return false;
+			task = std::move(queues[q]->tasks.back());
+			queues[q]->tasks.pop_back();
+			--queued;
+			return true;
+		};
+
+		bool steal(u32 q, job& task) {
+			std::lock_guard<std::mutex> guard(queues[q]->lock);
+			if (queues[q]->tasks.empty()) return false;
+			task = std::move(queues[q]->tasks.front());
+			queues[q]->tasks.pop_front();
+			--queued;
+			return true;
+		};
+
+		bool find(u32 start, job& task) {
+			if (pop(start, task)) return true;
+			for (u32 i = 1; i < queues.size(); i++) {
+				if (steal((start + i) % u32(queues.size()), task)) return true;
+			};
+			return false;
+		};
+
+		void run(job& task) {
+			group& g = *task.from;
+			try {
+				task.task();
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> guard(g.errorLock);
+				if (!g.error) g.error = std::current_exception();
+			};
+			task.task = nullptr;
+
+			// the waiter may destroy g as soon as its count reaches zero, so g is not touched after that
+			bool last = --g.pending == 0;
+			--pending;
+			if (last) {
+				std::lock_guard<std::mutex> guard(sleepLock);
+				done.notify_all();
+			};
+		};
+
+		// runs queued tasks, of any group, until count reaches zero
+		void drain(const std::atomic<std::size_t>& count) {
+			job task;
+			u32 start = owner == this ? self : 0;
+			while (count > 0) {
+				if (find(start, task)) {
+					run(task);
+					continue;
+				};
+
+				std::unique_lock<std::mutex> guard(sleepLock);
+				done.wait_for(guard, std::chrono::milliseconds(1), [&count] { return count == 0; });
+			};
+		};
+
+		void work(u32 index) {
+			owner = this;
+			self = index;
+
+			job task;
+			while (true) {
+				if (find(index, task)) {
+					run(task);
+					continue;
+				};
+
+				std::unique_lock<std::mutex> guard(sleepLock);
+				wake.wait(guard, [this] { return stop || queued > 0; });
+				if (stop && queued == 0) return;
+			};
+		};
+
+	public:
+		pool(u32 threads = std::max(1u, std::thread::hardware_concurrency())) {
+			threads = std::max(threads, 1u);
+			for (u32 i = 0; i < threads; i++) {
+				queues.push_back(std::make_unique<queue>());
+			};
+			for (u32 i = 0; i < threads; i++) {
+				workers.emplace_back([this, i] { work(i); });
+			};
+		};
+
+		pool(const pool&) = delete;
+		pool& operator=(const pool&) = delete;
+
+		// an exception no wait() picked up is dropped
+		~pool() {
+			drain(pending);
+			{
+				std::lock_guard<std::mutex> guard(sleepLock);
+				stop = true;
+			}
+			wake.notify_all();
+			for (std::thread& t : workers) {
+				t.join();
+			};
+		};
+
+		u32 size() const {
+			return u32(workers.size());
+		};
+
+		// tasks submitted from a worker stay on its own deque, outside ones are dealt round-robin
+		void submit(group& g, std::function<void()> task) {
+			u32 q = owner == this ? self : next++ % u32(queues.size());
+			++g.pending;
+			++pending;
+			{
+				std::lock_guard<std::mutex> guard(queues[q]->lock);
+				queues[q]->tasks.push_back({ std::move(task), &g });
+				++queued;
+			}
+			std::lock_guard<std::mutex> guard(sleepLock);
+			wake.notify_one();
+		};
+
+		// blocks until every task of g has finished, running queued tasks on the calling thread meanwhile,
+		// then rethrows the first exception one of them threw since the last wait on g
+		void wait(group& g) {
+			drain(g.pending);
+
+			std::exception_ptr e;
+			{
+				std::lock_guard<std::mutex> guard(g.errorLock);
+				std::swap(e, g.error);
+			}
+			if (e) std::rethrow_exception(e);
+		};
+
+		void submit(std::function<void()> task) {
+			submit(shared, std::move(task));
+		};
+
+		// a task waiting on the shared group would count itself as pending forever; tasks use their own group
+		void wait() {
+			assert(owner != this && "pool::wait() called from inside a task, wait on a group instead");
+			wait(shared);
+		};
+	};
+};
\ No newline at end of file
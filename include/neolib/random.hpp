@@ -1,8 +1,16 @@
 #pragma once
 
+#include <bit>
+#include <span>
+#include <type_traits>
+
+#include "cpu.hpp"
 #include "math.hpp"
+#include "simd.hpp"
 
 namespace nl {
+	// bit reversal; at run time the byte-level stages are a single byte swap, or the compiler's
+	// bit reverse builtin where it has one
 	constexpr u8 reverse(u8 val) {
 		u8 x = (val & 0x55) << 1 | (val & 0xaa) >> 1;
 		x = (x & 0x33) << 2 | (x & 0xcc) >> 2;
@@ -11,6 +19,18 @@ namespace nl {
 	};
 
 	constexpr u16 reverse(u16 val) {
+		if (!std::is_constant_evaluated()) {
+#if defined(__clang__)
+			return __builtin_bitreverse16(val);
+#else
+			u16 x = byteswap(val);
+			x = (x & 0x5555) << 1 | (x & 0xaaaa) >> 1;
+			x = (x & 0x3333) << 2 | (x & 0xcccc) >> 2;
+			x = (x & 0x0f0f) << 4 | (x & 0xf0f0) >> 4;
+			return x;
+#endif
+		};
+
 		u16 x = (val & 0x5555) << 1 | (val & 0xaaaa) >> 1;
 		x = (x & 0x3333) << 2 | (x & 0xcccc) >> 2;
 		x = (x & 0x0f0f) << 4 | (x & 0xf0f0) >> 4;
@@ -19,6 +39,18 @@ namespace nl {
 	};
 
 	constexpr u32 reverse(u32 val) {
+		if (!std::is_constant_evaluated()) {
+#if defined(__clang__)
+			return __builtin_bitreverse32(val);
+#else
+			u32 x = byteswap(val);
+			x = (x & 0x55555555) << 1 | (x & 0xaaaaaaaa) >> 1;
+			x = (x & 0x33333333) << 2 | (x & 0xcccccccc) >> 2;
+			x = (x & 0x0f0f0f0f) << 4 | (x & 0xf0f0f0f0) >> 4;
+			return x;
+#endif
+		};
+
 		u32 x = (val & 0x55555555) << 1 | (val & 0xaaaaaaaa) >> 1;
 		x = (x & 0x33333333) << 2 | (x & 0xcccccccc) >> 2;
 		x = (x & 0x0f0f0f0f) << 4 | (x & 0xf0f0f0f0) >> 4;
@@ -28,6 +60,18 @@ namespace nl {
 	};
 
 	constexpr u64 reverse(u64 val) {
+		if (!std::is_constant_evaluated()) {
+#if defined(__clang__)
+			return __builtin_bitreverse64(val);
+#else
+			u64 x = byteswap(val);
+			x = (x & 0x5555555555555555) << 1 | (x & 0xaaaaaaaaaaaaaaaa) >> 1;
+			x = (x & 0x3333333333333333) << 2 | (x & 0xcccccccccccccccc) >> 2;
+			x = (x & 0x0f0f0f0f0f0f0f0f) << 4 | (x & 0xf0f0f0f0f0f0f0f0) >> 4;
+			return x;
+#endif
+		};
+
 		u64 x = (val & 0x5555555555555555) << 1 | (val & 0xaaaaaaaaaaaaaaaa) >> 1;
 		x = (x & 0x3333333333333333) << 2 | (x & 0xcccccccccccccccc) >> 2;
 		x = (x & 0x0f0f0f0f0f0f0f0f) << 4 | (x & 0xf0f0f0f0f0f0f0f0) >> 4;
@@ -37,6 +81,8 @@ namespace nl {
 		return x;
 	};
 
+	// swaps the halves and interleaves them: bit i of the low half goes to bit 2i + 1, bit i of the
+	// high half to bit 2i, which at run time is two pdep where the CPU has a fast one
 	constexpr u8 bitshuffle(u8 val) {
 		u8 x = (val << 4) | (val >> 4);
 		x = (x & 0x0c) << 2 | (x >> 2) & 0x0c | x & 0xc3;
@@ -45,6 +91,10 @@ namespace nl {
 	};
 
 	constexpr u16 bitshuffle(u16 val) {
+		if (!std::is_constant_evaluated() && cpu.fastPdep) {
+			return u16(deposit(u32(val), 0xaaaa) | deposit(u32(val) >> 8, 0x5555));
+		};
+
 		u16 x = (val << 8) | (val >> 8);
 		x = (x & 0x00f0) << 4 | (x >> 4) & 0x00f0 | x & 0xf00f;
 		x = (x & 0x0c0c) << 2 | (x >> 2) & 0x0c0c | x & 0xc3c3;
@@ -53,6 +103,10 @@ namespace nl {
 	};
 
 	constexpr u32 bitshuffle(u32 val) {
+		if (!std::is_constant_evaluated() && cpu.fastPdep) {
+			return deposit(val, 0xaaaaaaaa) | deposit(val >> 16, 0x55555555);
+		};
+
 		u32 x = (val << 16) | (val >> 16);
 		x = (x & 0x0000ff00) << 8 | (x >> 8) & 0x0000ff00 | x & 0xff0000ff;
 		x = (x & 0x00f000f0) << 4 | (x >> 4) & 0x00f000f0 | x & 0xf00ff00f;
@@ -62,6 +116,10 @@ namespace nl {
 	};
 
 	constexpr u64 bitshuffle(u64 val) {
+		if (!std::is_constant_evaluated() && cpu.fastPdep) {
+			return deposit(val, 0xaaaaaaaaaaaaaaaa) | deposit(val >> 32, 0x5555555555555555);
+		};
+
 		u64 x = (val << 32) | (val >> 32);
 		x = (x & 0x00000000ffff0000) << 16 | (x >> 16) & 0x00000000ffff0000 | x & 0xffff00000000ffff;
 		x = (x & 0x0000ff000000ff00) << 8 | (x >> 8) & 0x0000ff000000ff00 | x & 0xff0000ffff0000ff;
@@ -103,108 +161,82 @@ namespace nl {
 		return 6364136223846793005 * seed + 100000001;
 	};
 
+	// splitmix64 finaliser: every input bit flips each output bit with probability close to 1/2
+	constexpr u64 mix64(u64 x) {
+		x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+		x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+		return x ^ (x >> 31);
+	};
+
+	// each quarter of the shuffled seed becomes the xor of the other three, i.e. itself xor the xor of
+	// all four, which is folded down once and spread back over every quarter
 	constexpr u8 quarter_u8(u8 seed) {
 		seed = bitshuffle(seed);
 
-		u8 q0 = (seed & 0x03);
-		u8 q1 = (seed & 0x0c) >> 2;
-		u8 q2 = (seed & 0x30) >> 4;
-		u8 q3 = (seed & 0xc0) >> 6;
-
-		return (q1 ^ q2 ^ q3) ^ ((q2 ^ q3 ^ q0) << 2) ^ ((q3 ^ q0 ^ q1) << 4) ^ ((q0 ^ q1 ^ q2) << 6);
+		u8 x = seed ^ (seed >> 4);
+		x = (x ^ (x >> 2)) & 0x03;
+		return seed ^ (x * 0x55);
 	};
 
 	constexpr u16 quarter_u16(u16 seed) {
 		seed = bitshuffle(seed);
 
-		u16 q0 = (seed & 0x000f);
-		u16 q1 = (seed & 0x00f0) >> 4;
-		u16 q2 = (seed & 0x0f00) >> 8;
-		u16 q3 = (seed & 0xf000) >> 12;
-
-		return (q1 ^ q2 ^ q3) ^ ((q2 ^ q3 ^ q0) << 4) ^ ((q3 ^ q0 ^ q1) << 8) ^ ((q0 ^ q1 ^ q2) << 12);
+		u16 x = seed ^ (seed >> 8);
+		x = (x ^ (x >> 4)) & 0x000f;
+		return seed ^ (x * 0x1111);
 	};
 
 	constexpr u32 quarter_u32(u32 seed) {
 		seed = bitshuffle(seed);
 
-		u32 q0 = (seed & 0x000000ff);
-		u32 q1 = (seed & 0x0000ff00) >> 8;
-		u32 q2 = (seed & 0x00ff0000) >> 16;
-		u32 q3 = (seed & 0xff000000) >> 24;
-
-		return (q1 ^ q2 ^ q3) ^ ((q2 ^ q3 ^ q0) << 8) ^ ((q3 ^ q0 ^ q1) << 16) ^ ((q0 ^ q1 ^ q2) << 24);
+		u32 x = seed ^ (seed >> 16);
+		x = (x ^ (x >> 8)) & 0x000000ff;
+		return seed ^ (x * 0x01010101);
 	};
 
 	constexpr u64 quarter_u64(u64 seed) {
 		seed = bitshuffle(seed);
 
-		u64 q0 = (seed & 0x000000000000ffff);
-		u64 q1 = (seed & 0x00000000ffff0000) >> 16;
-		u64 q2 = (seed & 0x0000ffff00000000) >> 32;
-		u64 q3 = (seed & 0xffff000000000000) >> 48;
-
-		return (q1 ^ q2 ^ q3) ^ ((q2 ^ q3 ^ q0) << 16) ^ ((q3 ^ q0 ^ q1) << 32) ^ ((q0 ^ q1 ^ q2) << 48);
+		u64 x = seed ^ (seed >> 32);
+		x = (x ^ (x >> 16)) & 0x000000000000ffff;
+		return seed ^ (x * 0x0001000100010001);
 	};
 
+	// the same with eighths: each becomes the xor of the other seven
 	constexpr u8 eighth_u8(u8 seed) {
 		seed = bitshuffle(seed);
 
-		u8 e0 = (seed & 0x01);
-		u8 e1 = (seed & 0x02) >> 1;
-		u8 e2 = (seed & 0x04) >> 2;
-		u8 e3 = (seed & 0x08) >> 3;
-		u8 e4 = (seed & 0x10) >> 4;
-		u8 e5 = (seed & 0x20) >> 5;
-		u8 e6 = (seed & 0x40) >> 6;
-		u8 e7 = (seed & 0x80) >> 7;
-
-		return (e1 ^ e2 ^ e3 ^ e4 ^ e5 ^ e6 ^ e7) ^ ((e2 ^ e3 ^ e4 ^ e5 ^ e6 ^ e7 ^ e0) << 1) ^ ((e3 ^ e4 ^ e5 ^ e6 ^ e7 ^ e0 ^ e1) << 2) ^ ((e4 ^ e5 ^ e6 ^ e7 ^ e0 ^ e1 ^ e2) << 3) ^ ((e5 ^ e6 ^ e7 ^ e0 ^ e1 ^ e2 ^ e3) << 4) ^ ((e6 ^ e7 ^ e0 ^ e1 ^ e2 ^ e3 ^ e4) << 5) ^ ((e7 ^ e0 ^ e1 ^ e2 ^ e3 ^ e4 ^ e5) << 6) ^ ((e0 ^ e1 ^ e2 ^ e3 ^ e4 ^ e5 ^ e6) << 7);
+		u8 x = seed ^ (seed >> 4);
+		x ^= x >> 2;
+		x = (x ^ (x >> 1)) & 0x01;
+		return seed ^ (x * 0xff);
 	};
 
 	constexpr u16 eighth_u16(u16 seed) {
 		seed = bitshuffle(seed);
 
-		u16 e0 = (seed & 0x0003);
-		u16 e1 = (seed & 0x00c) >> 2;
-		u16 e2 = (seed & 0x0030) >> 4;
-		u16 e3 = (seed & 0x00c0) >> 6;
-		u16 e4 = (seed & 0x0300) >> 8;
-		u16 e5 = (seed & 0x0c00) >> 10;
-		u16 e6 = (seed & 0x3000) >> 12;
-		u16 e7 = (seed & 0xc000) >> 14;
-
-		return (e1 ^ e2 ^ e3 ^ e4 ^ e5 ^ e6 ^ e7) ^ ((e2 ^ e3 ^ e4 ^ e5 ^ e6 ^ e7 ^ e0) << 2) ^ ((e3 ^ e4 ^ e5 ^ e6 ^ e7 ^ e0 ^ e1) << 4) ^ ((e4 ^ e5 ^ e6 ^ e7 ^ e0 ^ e1 ^ e2) << 6) ^ ((e5 ^ e6 ^ e7 ^ e0 ^ e1 ^ e2 ^ e3) << 8) ^ ((e6 ^ e7 ^ e0 ^ e1 ^ e2 ^ e3 ^ e4) << 10) ^ ((e7 ^ e0 ^ e1 ^ e2 ^ e3 ^ e4 ^ e5) << 12) ^ ((e0 ^ e1 ^ e2 ^ e3 ^ e4 ^ e5 ^ e6) << 14);
+		u16 x = seed ^ (seed >> 8);
+		x ^= x >> 4;
+		x = (x ^ (x >> 2)) & 0x0003;
+		return seed ^ (x * 0x5555);
 	};
 
 	constexpr u32 eighth_u32(u32 seed) {
 		seed = bitshuffle(seed);
 
-		u32 e0 = (seed & 0x0000000f);
-		u32 e1 = (seed & 0x000000f0) >> 4;
-		u32 e2 = (seed & 0x00000f00) >> 8;
-		u32 e3 = (seed & 0x0000f000) >> 12;
-		u32 e4 = (seed & 0x000f0000) >> 16;
-		u32 e5 = (seed & 0x00f00000) >> 20;
-		u32 e6 = (seed & 0x0f000000) >> 24;
-		u32 e7 = (seed & 0xf0000000) >> 28;
-
-		return (e1 ^ e2 ^ e3 ^ e4 ^ e5 ^ e6 ^ e7) ^ ((e2 ^ e3 ^ e4 ^ e5 ^ e6 ^ e7 ^ e0) << 4) ^ ((e3 ^ e4 ^ e5 ^ e6 ^ e7 ^ e0 ^ e1) << 8) ^ ((e4 ^ e5 ^ e6 ^ e7 ^ e0 ^ e1 ^ e2) << 12) ^ ((e5 ^ e6 ^ e7 ^ e0 ^ e1 ^ e2 ^ e3) << 16) ^ ((e6 ^ e7 ^ e0 ^ e1 ^ e2 ^ e3 ^ e4) << 20) ^ ((e7 ^ e0 ^ e1 ^ e2 ^ e3 ^ e4 ^ e5) << 24) ^ ((e0 ^ e1 ^ e2 ^ e3 ^ e4 ^ e5 ^ e6) << 28);
+		u32 x = seed ^ (seed >> 16);
+		x ^= x >> 8;
+		x = (x ^ (x >> 4)) & 0x0000000f;
+		return seed ^ (x * 0x11111111);
 	};
 
 	constexpr u64 eighth_u64(u64 seed) {
 		seed = bitshuffle(seed);
 
-		u64 e0 = (seed & 0x00000000000000ff);
-		u64 e1 = (seed & 0x000000000000ff00) >> 8;
-		u64 e2 = (seed & 0x0000000000ff0000) >> 16;
-		u64 e3 = (seed & 0x00000000ff000000) >> 24;
-		u64 e4 = (seed & 0x000000ff00000000) >> 32;
-		u64 e5 = (seed & 0x0000ff0000000000) >> 40;
-		u64 e6 = (seed & 0x00ff000000000000) >> 48;
-		u64 e7 = (seed & 0xff00000000000000) >> 56;
-
-		return (e1 ^ e2 ^ e3 ^ e4 ^ e5 ^ e6 ^ e7) ^ ((e2 ^ e3 ^ e4 ^ e5 ^ e6 ^ e7 ^ e0) << 8) ^ ((e3 ^ e4 ^ e5 ^ e6 ^ e7 ^ e0 ^ e1) << 16) ^ ((e4 ^ e5 ^ e6 ^ e7 ^ e0 ^ e1 ^ e2) << 24) ^ ((e5 ^ e6 ^ e7 ^ e0 ^ e1 ^ e2 ^ e3) << 32) ^ ((e6 ^ e7 ^ e0 ^ e1 ^ e2 ^ e3 ^ e4) << 40) ^ ((e7 ^ e0 ^ e1 ^ e2 ^ e3 ^ e4 ^ e5) << 48) ^ ((e0 ^ e1 ^ e2 ^ e3 ^ e4 ^ e5 ^ e6) << 56);
+		u64 x = seed ^ (seed >> 32);
+		x ^= x >> 16;
+		x = (x ^ (x >> 8)) & 0x00000000000000ff;
+		return seed ^ (x * 0x0101010101010101);
 	};
 
 	constexpr u8 deprime_u8(u8 seed) {
@@ -238,22 +270,37 @@ namespace nl {
 		return ((p_5 * 17 + p_17) * 3 + p_3) * 257 + p_257;
 	};
 
-	constexpr u32 deprime_u32(u32 seed) {
-		u32 p_3 = seed % 3;
-		seed /= 3;
-		u32 p_5 = seed % 5;
-		seed /= 5;
-		u32 p_17 = seed % 17;
-		seed /= 17;
-		u32 p_257 = seed % 257;
-		seed /= 257;
-		u32 p_65537 = seed % 65537;
+	// x / D as a multiply and shift, exact for every u32 x for the 2^k + 1 moduli deprime_u32 uses;
+	// the magic number fits in 32 bits, so SIMD lanes can use a 32 x 32 bit high multiply
+	template<u32 D> struct divisor {
+		static constexpr u32 shift = 31 + std::bit_width(D);
+		static constexpr u64 magic = ((u64(1) << shift) + D - 1) / D;
+		static_assert(magic <= 0xffffffff, "divisor magic does not fit in 32 bits");
 
-		p_3 = (2 * p_3 + 1) % 3;
-		p_5 = (3 * p_5 + 1) % 5;
-		p_17 = (11 * p_17 + 1) % 17;
-		p_257 = (19 * p_257 + 1) % 257;
-		p_65537 = (263 * p_65537 + 1) % 65537;
+		static constexpr u32 div(u32 x) { return u32((x * magic) >> shift); };
+		static constexpr u32 mod(u32 x) { return x - div(x) * D; };
+	};
+
+	constexpr u32 deprime_u32(u32 seed) {
+		u32 q = divisor<3>::div(seed);
+		u32 p_3 = seed - q * 3;
+		seed = q;
+		q = divisor<5>::div(seed);
+		u32 p_5 = seed - q * 5;
+		seed = q;
+		q = divisor<17>::div(seed);
+		u32 p_17 = seed - q * 17;
+		seed = q;
+		q = divisor<257>::div(seed);
+		u32 p_257 = seed - q * 257;
+		seed = q;
+		u32 p_65537 = divisor<65537>::mod(seed);
+
+		p_3 = divisor<3>::mod(2 * p_3 + 1);
+		p_5 = divisor<5>::mod(3 * p_5 + 1);
+		p_17 = divisor<17>::mod(11 * p_17 + 1);
+		p_257 = divisor<257>::mod(19 * p_257 + 1);
+		p_65537 = divisor<65537>::mod(263 * p_65537 + 1);
 
 		return (((p_5 * 17 + p_17) * 257 + p_257) * 3 + p_3) * 65537 + p_65537;
 	};
@@ -297,20 +344,25 @@ namespace nl {
 		return eighth_u64(deprime_u64(seed));
 	};
 
+	// the halved value, negated when odd; one hash per call
 	constexpr s8 random_s8(u8 seed) {
-		return s8(random_u8(seed) / 2) * ((random_u8(seed) % 2) == 0 ? 1 : -1);
+		u8 r = random_u8(seed);
+		return s8(r / 2) * ((r % 2) == 0 ? 1 : -1);
 	};
 
 	constexpr s16 random_s16(u16 seed) {
-		return s16(random_u16(seed) / 2) * ((random_u16(seed) % 2) == 0 ? 1 : -1);
+		u16 r = random_u16(seed);
+		return s16(r / 2) * ((r % 2) == 0 ? 1 : -1);
 	};
 
 	constexpr s32 random_s32(u32 seed) {
-		return s32(random_u32(seed) / 2) * ((random_u32(seed) % 2) == 0 ? 1 : -1);
+		u32 r = random_u32(seed);
+		return s32(r / 2) * ((r % 2) == 0 ? 1 : -1);
 	};
 
 	constexpr s64 random_s64(u64 seed) {
-		return s64(random_u64(seed) / 2) * ((random_u64(seed) % 2) == 0 ? 1 : -1);
+		u64 r = random_u64(seed);
+		return s64(r / 2) * ((r % 2) == 0 ? 1 : -1);
 	};
 
 	/*constexpr float random_ufloat(u32 seed) {
@@ -366,4 +418,226 @@ namespace nl {
 	constexpr f64 random_sf64(u16 seed) {
 		return random_unclamped_sf64(seed) * random_clamped_sf64(seed);
 	};*/
-}
\ No newline at end of file
+
+	// hashes of integer coordinates, e.g. lattice points, under a seed
+	//
+	// every coordinate is multiplied into the state and followed by a xorshift-multiply, so the next
+	// one lands on a nonlinear function of the ones before it; the finish is the second half of
+	// lowbias32. Flipping any input bit flips every output bit with probability 1/2 within 0.005
+	constexpr u32 hashAbsorb(u32 h, u32 v, u32 k) {
+		h ^= v * k;
+		return (h ^ (h >> 16)) * 0x7feb352d;
+	};
+
+	constexpr u32 hashFinish(u32 h) {
+		h = (h ^ (h >> 15)) * 0x846ca68b;
+		return h ^ (h >> 16);
+	};
+
+	constexpr u32 hash2d(u32 seed, u32 x, u32 y) {
+		return hashFinish(hashAbsorb(hashAbsorb(seed, x, 0x9e3779b1), y, 0x85ebca77));
+	};
+
+	constexpr u32 hash3d(u32 seed, u32 x, u32 y, u32 z) {
+		return hashFinish(hashAbsorb(hashAbsorb(hashAbsorb(seed, x, 0x9e3779b1), y, 0x85ebca77), z, 0xc2b2ae3d));
+	};
+
+	constexpr u32 hash4d(u32 seed, u32 x, u32 y, u32 z, u32 w) {
+		return hashFinish(hashAbsorb(hashAbsorb(hashAbsorb(hashAbsorb(seed, x, 0x9e3779b1), y, 0x85ebca77), z, 0xc2b2ae3d), w, 0x27d4eb2f));
+	};
+
+	// the u32 functions on simd::upack<W> lanes, bit-exact with the scalar ones
+	template<std::size_t W> simd::upack<W> bitshuffle(const simd::upack<W>& val) {
+		using U = simd::upack<W>;
+		U x = (val << 16) | (val >> 16);
+		x = (x & U::broadcast(0x0000ff00)) << 8 | (x >> 8) & U::broadcast(0x0000ff00) | x & U::broadcast(0xff0000ff);
+		x = (x & U::broadcast(0x00f000f0)) << 4 | (x >> 4) & U::broadcast(0x00f000f0) | x & U::broadcast(0xf00ff00f);
+		x = (x & U::broadcast(0x0c0c0c0c)) << 2 | (x >> 2) & U::broadcast(0x0c0c0c0c) | x & U::broadcast(0xc3c3c3c3);
+		x = (x & U::broadcast(0x22222222)) << 1 | (x >> 1) & U::broadcast(0x22222222) | x & U::broadcast(0x99999999);
+		return x;
+	};
+
+	template<std::size_t W> simd::upack<W> eighth_u32(const simd::upack<W>& seed) {
+		using U = simd::upack<W>;
+		U s = bitshuffle(seed);
+
+		U x = s ^ (s >> 16);
+		x = x ^ (x >> 8);
+		x = (x ^ (x >> 4)) & U::broadcast(0x0000000f);
+		return s ^ x * U::broadcast(0x11111111);
+	};
+
+	template<u32 D, std::size_t W> simd::upack<W> divide(const simd::upack<W>& x) {
+		using U = simd::upack<W>;
+		return mulhi(x, U::broadcast(u32(divisor<D>::magic))) >> (divisor<D>::shift - 32);
+	};
+
+	template<u32 D, std::size_t W> simd::upack<W> modulo(const simd::upack<W>& x) {
+		using U = simd::upack<W>;
+		return x - divide<D>(x) * U::broadcast(D);
+	};
+
+	template<std::size_t W> simd::upack<W> deprime_u32(const simd::upack<W>& seed) {
+		using U = simd::upack<W>;
+		U q = divide<3>(seed);
+		U p_3 = seed - q * U::broadcast(3);
+		U s = q;
+		q = divide<5>(s);
+		U p_5 = s - q * U::broadcast(5);
+		s = q;
+		q = divide<17>(s);
+		U p_17 = s - q * U::broadcast(17);
+		s = q;
+		q = divide<257>(s);
+		U p_257 = s - q * U::broadcast(257);
+		s = q;
+		U p_65537 = modulo<65537>(s);
+
+		p_3 = modulo<3>(p_3 * U::broadcast(2) + U::broadcast(1));
+		p_5 = modulo<5>(p_5 * U::broadcast(3) + U::broadcast(1));
+		p_17 = modulo<17>(p_17 * U::broadcast(11) + U::broadcast(1));
+		p_257 = modulo<257>(p_257 * U::broadcast(19) + U::broadcast(1));
+		p_65537 = modulo<65537>(p_65537 * U::broadcast(263) + U::broadcast(1));
+
+		return (((p_5 * U::broadcast(17) + p_17) * U::broadcast(257) + p_257) * U::broadcast(3) + p_3) * U::broadcast(65537) + p_65537;
+	};
+
+	template<std::size_t W> simd::upack<W> random_u32(const simd::upack<W>& seed) {
+		return eighth_u32(deprime_u32(seed));
+	};
+
+	// random_s32 as two's complement bits: odd values negate the halved one
+	template<std::size_t W> simd::upack<W> random_s32(const simd::upack<W>& seed) {
+		using U = simd::upack<W>;
+		U r = random_u32(seed);
+		U sign = U::broadcast(0) - (r & U::broadcast(1));
+		return ((r >> 1) ^ sign) - sign;
+	};
+
+	template<std::size_t W> simd::upack<W> hashAbsorb(const simd::upack<W>& h, const simd::upack<W>& v, u32 k) {
+		using U = simd::upack<W>;
+		U x = h ^ v * U::broadcast(k);
+		return (x ^ (x >> 16)) * U::broadcast(0x7feb352d);
+	};
+
+	template<std::size_t W> simd::upack<W> hashFinish(const simd::upack<W>& h) {
+		using U = simd::upack<W>;
+		U x = (h ^ (h >> 15)) * U::broadcast(0x846ca68b);
+		return x ^ (x >> 16);
+	};
+
+	template<std::size_t W> simd::upack<W> hash2d(u32 seed, const simd::upack<W>& x, const simd::upack<W>& y) {
+		return hashFinish(hashAbsorb(hashAbsorb(simd::upack<W>::broadcast(seed), x, 0x9e3779b1), y, 0x85ebca77));
+	};
+
+	template<std::size_t W> simd::upack<W> hash3d(u32 seed, const simd::upack<W>& x, const simd::upack<W>& y, const simd::upack<W>& z) {
+		return hashFinish(hashAbsorb(hashAbsorb(hashAbsorb(simd::upack<W>::broadcast(seed), x, 0x9e3779b1), y, 0x85ebca77), z, 0xc2b2ae3d));
+	};
+
+	template<std::size_t W> simd::upack<W> hash4d(u32 seed, const simd::upack<W>& x, const simd::upack<W>& y, const simd::upack<W>& z, const simd::upack<W>& w) {
+		return hashFinish(hashAbsorb(hashAbsorb(hashAbsorb(hashAbsorb(simd::upack<W>::broadcast(seed), x, 0x9e3779b1), y, 0x85ebca77), z, 0xc2b2ae3d), w, 0x27d4eb2f));
+	};
+
+	// out[i] = f(seeds[i]), simd::f32width lanes at a time
+	template<typename F> void randomBatch(std::span<const u32> seeds, u32* out, F f) {
+		using U = simd::upack<simd::f32width>;
+
+		std::size_t i = 0;
+		for (; i + simd::f32width <= seeds.size(); i += simd::f32width) {
+			f(U::load(seeds.data() + i)).store(out + i);
+		};
+		for (; i < seeds.size(); i++) {
+			out[i] = f(simd::upack<1>{ seeds[i] }).v;
+		};
+	};
+
+	// out[i] = scale * f(seeds[i]) converted to f64, simd::f64width lanes at a time; the scales are
+	// powers of two, so the product rounds exactly like the scalar division
+	template<bool Signed, typename F> void randomBatch(std::span<const u32> seeds, f64* out, f64 scale, F f) {
+		using P = simd::f64pack;
+		using U = P::index;
+
+		std::size_t i = 0;
+		for (; i + P::width <= seeds.size(); i += P::width) {
+			U r = f(U::load(seeds.data() + i));
+			P v = Signed ? P::fromIndex(r) : P::fromUnsigned(r);
+			(v * P::broadcast(scale)).store(out + i);
+		};
+		for (; i < seeds.size(); i++) {
+			u32 r = f(simd::upack<1>{ seeds[i] }).v;
+			out[i] = (Signed ? f64(s32(r)) : f64(r)) * scale;
+		};
+	};
+
+	// batch versions of the scalar functions: out[i] = f(seeds[i]) for every seed, out must hold at
+	// least seeds.size() values; the u32 seeded ones run on the widest simd::upack available
+	inline void random_u32(std::span<const u32> seeds, std::span<u32> out) {
+		randomBatch(seeds, out.data(), [](const auto& s) { return random_u32(s); });
+	};
+
+	inline void random_s32(std::span<const u32> seeds, std::span<s32> out) {
+		randomBatch(seeds, reinterpret_cast<u32*>(out.data()), [](const auto& s) { return random_s32(s); });
+	};
+
+	// deprime_u64 divides by 2^32 + 1, which needs a 64 x 64 bit high multiply no SIMD extension has,
+	// so this is a scalar loop
+	inline void random_u64(std::span<const u64> seeds, std::span<u64> out) {
+		for (std::size_t i = 0; i < seeds.size(); i++) {
+			out[i] = random_u64(seeds[i]);
+		};
+	};
+
+	inline void random_clamped_uf64(std::span<const u32> seeds, std::span<f64> out) {
+		randomBatch<false>(seeds, out.data(), 1.0 / 4294967296.0, [](const auto& s) { return random_u32(s); });
+	};
+
+	inline void random_clamped_sf64(std::span<const u32> seeds, std::span<f64> out) {
+		randomBatch<true>(seeds, out.data(), 1.0 / 2147483648.0, [](const auto& s) { return random_s32(s); });
+	};
+
+	inline void random_unclamped_uf64(std::span<const u32> seeds, std::span<f64> out) {
+		randomBatch<false>(seeds, out.data(), 4294967296.0, [](const auto& s) { return random_u32(~s); });
+	};
+
+	inline void random_unclamped_sf64(std::span<const u32> seeds, std::span<f64> out) {
+		randomBatch<true>(seeds, out.data(), 2147483648.0, [](const auto& s) { return random_s32(~s); });
+	};
+
+	// out[i] = hashNd(seed, xs[i], ys[i], ...) for every i < xs.size(); the other spans must be at least
+	// as long
+	inline void hash2d(u32 seed, std::span<const u32> xs, std::span<const u32> ys, std::span<u32> out) {
+		using U = simd::upack<simd::f32width>;
+
+		std::size_t i = 0;
+		for (; i + simd::f32width <= xs.size(); i += simd::f32width) {
+			hash2d(seed, U::load(xs.data() + i), U::load(ys.data() + i)).store(out.data() + i);
+		};
+		for (; i < xs.size(); i++) {
+			out[i] = hash2d(seed, xs[i], ys[i]);
+		};
+	};
+
+	inline void hash3d(u32 seed, std::span<const u32> xs, std::span<const u32> ys, std::span<const u32> zs, std::span<u32> out) {
+		using U = simd::upack<simd::f32width>;
+
+		std::size_t i = 0;
+		for (; i + simd::f32width <= xs.size(); i += simd::f32width) {
+			hash3d(seed, U::load(xs.data() + i), U::load(ys.data() + i), U::load(zs.data() + i)).store(out.data() + i);
+		};
+		for (; i < xs.size(); i++) {
+			out[i] = hash3d(seed, xs[i], ys[i], zs[i]);
+		};
+	};
+
+	inline void hash4d(u32 seed, std::span<const u32> xs, std::span<const u32> ys, std::span<const u32> zs, std::span<const u32> ws, std::span<u32> out) {
+		using U = simd::upack<simd::f32width>;
+
+		std::size_t i = 0;
+		for (; i + simd::f32width <= xs.size(); i += simd::f32width) {
+			hash4d(seed, U::load(xs.data() + i), U::load(ys.data() + i), U::load(zs.data() + i), U::load(ws.data() + i)).store(out.data() + i);
+		};
+		for (; i < xs.size(); i++) {
+			out[i] = hash4d(seed, xs[i], ys[i], zs[i], ws[i]);
+		};
+	};
+}
@@ -0,0 +1,258 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include "base.hpp"
+
+namespace nl {
+	namespace simd {
+		// thin wrappers over the widest registers enabled at compile time (/arch:AVX2, /arch:AVX512);
+		// pack<T, 1> / upack<1> are plain scalars so every kernel also builds without SIMD
+		template<typename T, std::size_t W> struct pack;
+		template<std::size_t W> struct upack;
+
+#if defined(__AVX512F__)
+		constexpr std::size_t f64width = 8;
+		constexpr std::size_t f32width = 16;
+#elif defined(__AVX2__)
+		constexpr std::size_t f64width = 4;
+		constexpr std::size_t f32width = 8;
+#else
+		constexpr std::size_t f64width = 1;
+		constexpr std::size_t f32width = 1;
+#endif
+
+		template<> struct upack<1> {
+			u32 v;
+
+			static upack broadcast(u32 x) { return { x }; };
+			static upack load(const u32* p) { return { p[0] }; };
+			void store(u32* p) const { p[0] = v; };
+
+			friend upack operator+(const upack& a, const upack& b) { return { a.v + b.v }; };
+			friend upack operator-(const upack& a, const upack& b) { return { a.v - b.v }; };
+			friend upack operator*(const upack& a, const upack& b) { return { a.v * b.v }; };
+			friend upack operator^(const upack& a, const upack& b) { return { a.v ^ b.v }; };
+			friend upack operator&(const upack& a, const upack& b) { return { a.v & b.v }; };
+			friend upack operator|(const upack& a, const upack& b) { return { a.v | b.v }; };
+			friend upack operator~(const upack& a) { return { ~a.v }; };
+			friend upack operator>>(const upack& a, int n) { return { a.v >> n }; };
+			friend upack operator<<(const upack& a, int n) { return { a.v << n }; };
+
+			// high 32 bits of the full 64 bit products
+			friend upack mulhi(const upack& a, const upack& b) { return { u32((u64(a.v) * b.v) >> 32) }; };
+		};
+
+		template<typename T> struct pack<T, 1> {
+			using scalar = T;
+			using index = upack<1>;
+			static constexpr std::size_t width = 1;
+			T v;
+
+			static pack broadcast(T x) { return { x }; };
+			static pack load(const T* p) { return { p[0] }; };
+			void store(T* p) const { p[0] = v; };
+
+			friend pack operator+(const pack& a, const pack& b) { return { a.v + b.v }; };
+			friend pack operator-(const pack& a, const pack& b) { return { a.v - b.v }; };
+			friend pack operator*(const pack& a, const pack& b) { return { a.v * b.v }; };
+
+			pack floor() const { return { std::floor(v) }; };
+			index toIndex() const { return { u32(s32(v)) }; };
+
+			static pack fromIndex(const index& i) { return { T(s32(i.v)) }; };
+			static pack fromUnsigned(const index& i) { return { T(i.v) }; };
+			static pack gather(const T* table, const index& i) { return { table[i.v] }; };
+		};
+
+#if defined(__AVX2__)
+		template<> struct upack<4> {
+			__m128i v;
+
+			static upack broadcast(u32 x) { return { _mm_set1_epi32(s32(x)) }; };
+			static upack load(const u32* p) { return { _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)) }; };
+			void store(u32* p) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); };
+
+			friend upack operator+(const upack& a, const upack& b) { return { _mm_add_epi32(a.v, b.v) }; };
+			friend upack operator-(const upack& a, const upack& b) { return { _mm_sub_epi32(a.v, b.v) }; };
+			friend upack operator*(const upack& a, const upack& b) { return { _mm_mullo_epi32(a.v, b.v) }; };
+			friend upack operator^(const upack& a, const upack& b) { return { _mm_xor_si128(a.v, b.v) }; };
+			friend upack operator&(const upack& a, const upack& b) { return { _mm_and_si128(a.v, b.v) }; };
+			friend upack operator|(const upack& a, const upack& b) { return { _mm_or_si128(a.v, b.v) }; };
+			friend upack operator~(const upack& a) { return { _mm_xor_si128(a.v, _mm_set1_epi32(-1)) }; };
+			friend upack operator>>(const upack& a, int n) { return { _mm_srl_epi32(a.v, _mm_cvtsi32_si128(n)) }; };
+			friend upack operator<<(const upack& a, int n) { return { _mm_sll_epi32(a.v, _mm_cvtsi32_si128(n)) }; };
+
+			// mul_epu32 multiplies the even lanes into 64 bit products: the even lanes' high halves are
+			// shifted down into place, the odd lanes' are multiplied from shifted operands and land in place
+			friend upack mulhi(const upack& a, const upack& b) {
+				__m128i even = _mm_srli_epi64(_mm_mul_epu32(a.v, b.v), 32);
+				__m128i odd = _mm_mul_epu32(_mm_srli_epi64(a.v, 32), _mm_srli_epi64(b.v, 32));
+				return { _mm_blend_epi32(even, odd, 0xa) };
+			};
+		};
+
+		template<> struct upack<8> {
+			__m256i v;
+
+			static upack broadcast(u32 x) { return { _mm256_set1_epi32(s32(x)) }; };
+			static upack load(const u32* p) { return { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)) }; };
+			void store(u32* p) const { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); };
+
+			friend upack operator+(const upack& a, const upack& b) { return { _mm256_add_epi32(a.v, b.v) }; };
+			friend upack operator-(const upack& a, const upack& b) { return { _mm256_sub_epi32(a.v, b.v) }; };
+			friend upack operator*(const upack& a, const upack& b) { return { _mm256_mullo_epi32(a.v, b.v) }; };
+			friend upack operator^(const upack& a, const upack& b) { return { _mm256_xor_si256(a.v, b.v) }; };
+			friend upack operator&(const upack& a, const upack& b) { return { _mm256_and_si256(a.v, b.v) }; };
+			friend upack operator|(const upack& a, const upack& b) { return { _mm256_or_si256(a.v, b.v) }; };
+			friend upack operator~(const upack& a) { return { _mm256_xor_si256(a.v, _mm256_set1_epi32(-1)) }; };
+			friend upack operator>>(const upack& a, int n) { return { _mm256_srl_epi32(a.v, _mm_cvtsi32_si128(n)) }; };
+			friend upack operator<<(const upack& a, int n) { return { _mm256_sll_epi32(a.v, _mm_cvtsi32_si128(n)) }; };
+
+			// mul_epu32 multiplies the even lanes into 64 bit products: the even lanes' high halves are
+			// shifted down into place, the odd lanes' are multiplied from shifted operands and land in place
+			friend upack mulhi(const upack& a, const upack& b) {
+				__m256i even = _mm256_srli_epi64(_mm256_mul_epu32(a.v, b.v), 32);
+				__m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a.v, 32), _mm256_srli_epi64(b.v, 32));
+				return { _mm256_blend_epi32(even, odd, 0xaa) };
+			};
+		};
+
+		template<> struct pack<f64, 4> {
+			using scalar = f64;
+			using index = upack<4>;
+			static constexpr std::size_t width = 4;
+			__m256d v;
+
+			static pack broadcast(f64 x) { return { _mm256_set1_pd(x) }; };
+			static pack load(const f64* p) { return { _mm256_loadu_pd(p) }; };
+			void store(f64* p) const { _mm256_storeu_pd(p, v); };
+
+			friend pack operator+(const pack& a, const pack& b) { return { _mm256_add_pd(a.v, b.v) }; };
+			friend pack operator-(const pack& a, const pack& b) { return { _mm256_sub_pd(a.v, b.v) }; };
+			friend pack operator*(const pack& a, const pack& b) { return { _mm256_mul_pd(a.v, b.v) }; };
+
+			pack floor() const { return { _mm256_floor_pd(v) }; };
+			index toIndex() const { return { _mm256_cvttpd_epi32(v) }; };
+
+			static pack fromIndex(const index& i) { return { _mm256_cvtepi32_pd(i.v) }; };
+			static pack fromUnsigned(const index& i) {
+				__m128i flipped = _mm_xor_si128(i.v, _mm_set1_epi32(s32(0x80000000)));
+				return { _mm256_add_pd(_mm256_cvtepi32_pd(flipped), _mm256_set1_pd(2147483648.0)) };
+			};
+			static pack gather(const f64* table, const index& i) { return { _mm256_i32gather_pd(table, i.v, 8) }; };
+		};
+
+		template<> struct pack<f32, 8> {
+			using scalar = f32;
+			using index = upack<8>;
+			static constexpr std::size_t width = 8;
+			__m256 v;
+
+			static pack broadcast(f32 x) { return { _mm256_set1_ps(x) }; };
+			static pack load(const f32* p) { return { _mm256_loadu_ps(p) }; };
+			void store(f32* p) const { _mm256_storeu_ps(p, v); };
+
+			friend pack operator+(const pack& a, const pack& b) { return { _mm256_add_ps(a.v, b.v) }; };
+			friend pack operator-(const pack& a, const pack& b) { return { _mm256_sub_ps(a.v, b.v) }; };
+			friend pack operator*(const pack& a, const pack& b) { return { _mm256_mul_ps(a.v, b.v) }; };
+
+			pack floor() const { return { _mm256_floor_ps(v) }; };
+			index toIndex() const { return { _mm256_cvttps_epi32(v) }; };
+
+			static pack fromIndex(const index& i) { return { _mm256_cvtepi32_ps(i.v) }; };
+			// exact halves, so the final add performs the only rounding, as the scalar conversion does
+			static pack fromUnsigned(const index& i) {
+				__m256 hi = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(i.v, 16)), _mm256_set1_ps(65536.0f));
+				__m256 lo = _mm256_cvtepi32_ps(_mm256_and_si256(i.v, _mm256_set1_epi32(0xffff)));
+				return { _mm256_add_ps(hi, lo) };
+			};
+			static pack gather(const f32* table, const index& i) { return { _mm256_i32gather_ps(table, i.v, 4) }; };
+		};
+#endif
+
+#if defined(__AVX512F__)
+		template<> struct pack<f64, 8> {
+			using scalar = f64;
+			using index = upack<8>;
+			static constexpr std::size_t width = 8;
+			__m512d v;
+
+			static pack broadcast(f64 x) { return { _mm512_set1_pd(x) }; };
+			static pack load(const f64* p) { return { _mm512_loadu_pd(p) }; };
+			void store(f64* p) const { _mm512_storeu_pd(p, v); };
+
+			friend pack operator+(const pack& a, const pack& b) { return { _mm512_add_pd(a.v, b.v) }; };
+			friend pack operator-(const pack& a, const pack& b) { return { _mm512_sub_pd(a.v, b.v) }; };
+			friend pack operator*(const pack& a, const pack& b) { return { _mm512_mul_pd(a.v, b.v) }; };
+
+			pack floor() const { return { _mm512_roundscale_pd(v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC) }; };
+			index toIndex() const { return { _mm512_cvttpd_epi32(v) }; };
+
+			static pack fromIndex(const index& i) { return { _mm512_cvtepi32_pd(i.v) }; };
+			static pack fromUnsigned(const index& i) { return { _mm512_cvtepu32_pd(i.v) }; };
+			static pack gather(const f64* table, const index& i) { return { _mm512_i32gather_pd(i.v, table, 8) }; };
+		};
+
+		template<> struct upack<16> {
+			__m512i v;
+
+			static upack broadcast(u32 x) { return { _mm512_set1_epi32(s32(x)) }; };
+			static upack load(const u32* p) { return { _mm512_loadu_si512(p) }; };
+			void store(u32* p) const { _mm512_storeu_si512(p, v); };
+
+			friend upack operator+(const upack& a, const upack& b) { return { _mm512_add_epi32(a.v, b.v) }; };
+			friend upack operator-(const upack& a, const upack& b) { return { _mm512_sub_epi32(a.v, b.v) }; };
+			friend upack operator*(const upack& a, const upack& b) { return { _mm512_mullo_epi32(a.v, b.v) }; };
+			friend upack operator^(const upack& a, const upack& b) { return { _mm512_xor_si512(a.v, b.v) }; };
+			friend upack operator&(const upack& a, const upack& b) { return { _mm512_and_si512(a.v, b.v) }; };
+			friend upack operator|(const upack& a, const upack& b) { return { _mm512_or_si512(a.v, b.v) }; };
+			friend upack operator~(const upack& a) { return { _mm512_xor_si512(a.v, _mm512_set1_epi32(-1)) }; };
+			friend upack operator>>(const upack& a, int n) { return { _mm512_srl_epi32(a.v, _mm_cvtsi32_si128(n)) }; };
+			friend upack operator<<(const upack& a, int n) { return { _mm512_sll_epi32(a.v, _mm_cvtsi32_si128(n)) }; };
+
+			// mul_epu32 multiplies the even lanes into 64 bit products: the even lanes' high halves are
+			// shifted down into place, the odd lanes' are multiplied from shifted operands and land in place
+			friend upack mulhi(const upack& a, const upack& b) {
+				__m512i even = _mm512_srli_epi64(_mm512_mul_epu32(a.v, b.v), 32);
+				__m512i odd = _mm512_mul_epu32(_mm512_srli_epi64(a.v, 32), _mm512_srli_epi64(b.v, 32));
+				return { _mm512_mask_blend_epi32(0xaaaa, even, odd) };
+			};
+		};
+
+		template<> struct pack<f32, 16> {
+			using scalar = f32;
+			using index = upack<16>;
+			static constexpr std::size_t width = 16;
+			__m512 v;
+
+			static pack broadcast(f32 x) { return { _mm512_set1_ps(x) }; };
+			static pack load(const f32* p) { return { _mm512_loadu_ps(p) }; };
+			void store(f32* p) const { _mm512_storeu_ps(p, v); };
+
+			friend pack operator+(const pack& a, const pack& b) { return { _mm512_add_ps(a.v, b.v) }; };
+			friend pack operator-(const pack& a, const pack& b) { return { _mm512_sub_ps(a.v, b.v) }; };
+			friend pack operator*(const pack& a, const pack& b) { return { _mm512_mul_ps(a.v, b.v) }; };
+
+			pack floor() const { return { _mm512_roundscale_ps(v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC) }; };
+			index toIndex() const { return { _mm512_cvttps_epi32(v) }; };
+
+			static pack fromIndex(const index& i) { return { _mm512_cvtepi32_ps(i.v) }; };
+			static pack fromUnsigned(const index& i) { return { _mm512_cvtepu32_ps(i.v) }; };
+			static pack gather(const f32* table, const index& i) { return { _mm512_i32gather_ps(i.v, table, 4) }; };
+		};
+#endif
+
+		template<typename T> constexpr std::size_t widthOf = std::is_same_v<T, f32> ? f32width : f64width;
+		template<typename T> using packOf = pack<T, widthOf<T>>;
+
+		using f64pack = packOf<f64>;
+		using f32pack = packOf<f32>;
+	};
+};
\ No newline at end of file
@@ -66,6 +66,7 @@ namespace nl {
 		};
 
 		constexpr vector2(const angle& a) { x = std::cos(a.val()); y = std::sin(a.val()); };
+		vector2(const angle& a, sincosTier tier) { sincosPair p = a.sincos(tier); x = p.cos; y = p.sin; };
 	};
 };
 
@@ -114,9 +115,9 @@ template<typename T> struct std::equal_to<nl::vector2<T>> {
 
 template<typename T> struct std::hash<nl::vector2<T>> {
 	std::size_t operator()(nl::vector2<T> vec) const {
-		std::size_t res;
-		res = (res << 19) ^ (res >> 13); res ^= std::hash<T>{}(vec.x);
-		res = (res << 19) ^ (res >> 13); res ^= std::hash<T>{}(vec.y);
+		std::size_t res = 0;
+		res ^= std::hash<T>{}(vec.x) + 0x9e3779b9 + (res << 6) + (res >> 2);
+		res ^= std::hash<T>{}(vec.y) + 0x9e3779b9 + (res << 6) + (res >> 2);
 		return res;
 	};
 };
\ No newline at end of file
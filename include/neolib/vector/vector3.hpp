@@ -101,10 +101,10 @@ template<typename T> struct std::equal_to<nl::vector3<T>> {
 
 template<typename T> struct std::hash<nl::vector3<T>> {
 	std::size_t operator()(nl::vector3<T> vec) const {
-		std::size_t res;
-		res = (res << 19) ^ (res >> 13); res ^= std::hash<T>{}(vec.x);
-		res = (res << 19) ^ (res >> 13); res ^= std::hash<T>{}(vec.y);
-		res = (res << 19) ^ (res >> 13); res ^= std::hash<T>{}(vec.z);
+		std::size_t res = 0;
+		res ^= std::hash<T>{}(vec.x) + 0x9e3779b9 + (res << 6) + (res >> 2);
+		res ^= std::hash<T>{}(vec.y) + 0x9e3779b9 + (res << 6) + (res >> 2);
+		res ^= std::hash<T>{}(vec.z) + 0x9e3779b9 + (res << 6) + (res >> 2);
 		return res;
 	};
 };
\ No newline at end of file